@@ -42,5 +42,8 @@ public:
     void processKeyboardInput(const std::string& direction, float deltaTime, float speed);
 
     void processMouseInput(float xOffset, float yOffset, float sensitivity = 0.1f);
+
+    // Conservative test of a sphere against the view frustum, using a cone around the view direction
+    bool sphereInView(const Vec3& center, float radius) const;
 };
 
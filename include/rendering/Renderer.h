@@ -3,6 +3,7 @@
 #include "utilities/standard.h"
 #include "world/WorldManager.h"
 #include "utilities/ThreadManager.h"
+#include "utilities/FrameJobQueue.h"
 #include "Camera.h"
 #include "Shader.h"
 
@@ -40,6 +41,7 @@ private:
 
     Camera& camera;
     WorldManager& worldManager;
+    FrameJobQueue& frameJobs;
 
     void initGLSettings();
 
@@ -51,6 +53,9 @@ private:
 
     void updateWorldBuffers();
 
+    // Uploads the voxels of the chunk at the world position if it is still loaded and dirty
+    void uploadChunk(const Vec3& worldPosition);
+
     void loadLightBuffers();
 
     void loadGBuffer();
@@ -58,8 +63,9 @@ private:
     void loadBlueNoiseTexture();
 
 public:
-    Renderer(WorldManager& worldManager, Camera& camera)
-        : worldManager(worldManager), camera(camera) {
+    // Chunk uploads are queued on frameJobs, which the caller runs every frame
+    Renderer(WorldManager& worldManager, Camera& camera, FrameJobQueue& frameJobs)
+        : worldManager(worldManager), camera(camera), frameJobs(frameJobs) {
         initGLSettings();
         loadScreenQuad();
         loadMarker();
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+
+// Lock free stack that worker threads push finished items onto and one consumer takes
+// all of at once. Intrusive, T needs a T* nextCompleted member that only the stack uses.
+// Pushing releases the item's data, taking acquires it
+template <typename T>
+class CompletionStack {
+private:
+    std::atomic<T*> head = nullptr;
+
+public:
+    // Pushes a chain of items already linked from first to last through nextCompleted
+    void push(T* first, T* last) {
+        T* oldHead = head.load(std::memory_order_relaxed);
+        do {
+            last->nextCompleted = oldHead;
+        } while (!head.compare_exchange_weak(oldHead, first, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void push(T* item) { push(item, item); }
+
+    // Takes every item pushed so far and returns them in the order they were pushed
+    template <typename Callback>
+    void takeAll(Callback callback) {
+        T* item = head.exchange(nullptr, std::memory_order_acquire);
+
+        // The stack is newest first, reverse it
+        T* ordered = nullptr;
+        while (item) {
+            T* next = item->nextCompleted;
+            item->nextCompleted = ordered;
+            ordered = item;
+            item = next;
+        }
+
+        while (ordered) {
+            T* next = ordered->nextCompleted;
+            ordered->nextCompleted = nullptr;
+            callback(ordered);
+            ordered = next;
+        }
+    }
+
+    bool empty() const { return head.load(std::memory_order_relaxed) == nullptr; }
+};
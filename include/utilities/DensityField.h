@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+#include "utilities/standard.h"
+
+// Samples a 3D density function on a coarse lattice and fills a whole block
+// with trilinear interpolation. A lattice step of 1 samples every voxel.
+class DensityField {
+private:
+    int latticeStep;
+
+public:
+    static const int maxLatticeStep = 16;
+
+    DensityField(int latticeStep = 4);
+
+    int getLatticeStep() const { return latticeStep; }
+
+    // Sets the lattice step, clamped to [1, maxLatticeStep]. Lower is more accurate
+    void setLatticeStep(int step);
+
+    // Fills out[x + y * sizeX + z * sizeX * sizeY] with the density of the block starting at origin.
+    // The sampler is called with world coordinates, only on lattice points
+    void fill(const Vec3& origin, int sizeX, int sizeY, int sizeZ,
+              const std::function<double(double, double, double)>& sampler, float* out) const;
+};
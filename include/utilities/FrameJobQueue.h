@@ -0,0 +1,49 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "utilities/Task.h"
+
+// What the last run of a frame job queue did
+struct FrameJobStats {
+    int ran = 0;            // jobs run in the last frame
+    int deferred = 0;       // jobs left for the next frame
+    double ms = 0.0;        // time spent running them
+    int peakDeferred = 0;   // most jobs ever left over at the end of a frame
+    long long deferredFrames = 0;   // frames that ended with jobs left over
+};
+
+// Main thread work spread over frames. Jobs run in the order they were added until the
+// frame's time budget is spent, the rest carry over to the next frame. Jobs may hold on to
+// things that go away before they run, so they should look up what they work on when they run
+class FrameJobQueue {
+private:
+    std::deque<Task> jobs;
+    FrameJobStats stats;
+
+    // Jobs added from other threads, moved to the queue when it runs
+    std::vector<Task> incoming;
+    std::mutex incomingMutex;
+
+public:
+    double budgetMs;
+
+    FrameJobQueue(double budgetMs) : budgetMs(budgetMs) {}
+
+    void add(Task job) { jobs.push_back(std::move(job)); }
+
+    // Same, from any thread. Named like the thread manager's, so futures can continue on the main thread
+    void addTask(Task job) {
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        incoming.push_back(std::move(job));
+    }
+
+    // Runs jobs until the budget is spent. At least one job runs every frame, so a job
+    // that takes longer than the budget does not stall the queue
+    void run();
+
+    size_t size() const { return jobs.size(); }
+
+    const FrameJobStats& getStats() const { return stats; }
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "utilities/Task.h"
+
+template <typename T> class Future;
+template <typename T> class Promise;
+
+namespace futureDetail {
+    // The value of a finished future, void futures only remember that they finished
+    template <typename T>
+    struct Value {
+        std::optional<T> value;
+        bool isSet() const { return value.has_value(); }
+    };
+
+    template <>
+    struct Value<void> {
+        bool set = false;
+        bool isSet() const { return set; }
+    };
+
+    template <typename T>
+    struct State {
+        std::mutex mutex;
+        std::condition_variable condition;
+        Value<T> result;
+        std::vector<Task> continuations;
+
+        // Stores the value, wakes waiters and runs the continuations on this thread
+        template <typename... V>
+        void complete(V&&... value) {
+            std::vector<Task> ready;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if constexpr (std::is_void_v<T>) {
+                    result.set = true;
+                } else {
+                    result.value.emplace(std::forward<V>(value)...);
+                }
+                ready.swap(continuations);
+            }
+            condition.notify_all();
+            for (Task& continuation : ready) {
+                continuation();
+            }
+        }
+
+        // Runs the task once the future finished, right away if it already has
+        void attach(Task task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!result.isSet()) {
+                    continuations.push_back(std::move(task));
+                    return;
+                }
+            }
+            task();
+        }
+    };
+
+    template <typename T, typename F>
+    struct Continuation { using type = std::invoke_result_t<F, const T&>; };
+
+    template <typename F>
+    struct Continuation<void, F> { using type = std::invoke_result_t<F>; };
+
+    // Calls f with the value of a finished future and completes next with what it returns
+    template <typename T, typename R, typename F>
+    void invoke(F& f, State<T>& state, State<R>& next) {
+        if constexpr (std::is_void_v<T> && std::is_void_v<R>) {
+            f();
+            next.complete();
+        } else if constexpr (std::is_void_v<T>) {
+            next.complete(f());
+        } else if constexpr (std::is_void_v<R>) {
+            f(*state.result.value);
+            next.complete();
+        } else {
+            next.complete(f(*state.result.value));
+        }
+    }
+}
+
+// The result of work that finishes later, shared by every copy. Continuations added with
+// then() run once it finishes: on the thread that finished it, or handed to an executor,
+// anything with addTask(Task) such as the thread manager or the main thread's frame jobs
+template <typename T>
+class Future {
+private:
+    std::shared_ptr<futureDetail::State<T>> state;
+
+    template <typename> friend class Future;
+    friend class Promise<T>;
+
+    explicit Future(std::shared_ptr<futureDetail::State<T>> state) : state(std::move(state)) {}
+
+public:
+    Future() = default;
+
+    bool isValid() const { return state != nullptr; }
+
+    bool isReady() const {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        return state->result.isSet();
+    }
+
+    // Blocks until the future finished. Waiting inside a task can deadlock the pool,
+    // tasks should continue with then() instead
+    void wait() const {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [this]() { return state->result.isSet(); });
+    }
+
+    // The value, waiting for it if needed
+    template <typename U = T, typename = std::enable_if_t<!std::is_void_v<U>>>
+    const U& get() const {
+        wait();
+        return *state->result.value;
+    }
+
+    // Calls f with the value on the thread that finishes the future, or right away if it is ready
+    template <typename F>
+    auto then(F&& f) -> Future<typename futureDetail::Continuation<T, std::decay_t<F>>::type> {
+        using R = typename futureDetail::Continuation<T, std::decay_t<F>>::type;
+        auto next = std::make_shared<futureDetail::State<R>>();
+        state->attach([state = state, next, f = std::forward<F>(f)]() mutable {
+            futureDetail::invoke(f, *state, *next);
+        });
+        return Future<R>(next);
+    }
+
+    // Calls f with the value as a task added to the executor once the future finished
+    template <typename Executor, typename F>
+    auto then(Executor& executor, F&& f) -> Future<typename futureDetail::Continuation<T, std::decay_t<F>>::type> {
+        using R = typename futureDetail::Continuation<T, std::decay_t<F>>::type;
+        auto next = std::make_shared<futureDetail::State<R>>();
+        state->attach([&executor, state = state, next, f = std::forward<F>(f)]() mutable {
+            executor.addTask([state, next, f = std::move(f)]() mutable {
+                futureDetail::invoke(f, *state, *next);
+            });
+        });
+        return Future<R>(next);
+    }
+};
+
+// The producing side of a future, for work that is not a single task
+template <typename T>
+class Promise {
+private:
+    std::shared_ptr<futureDetail::State<T>> state = std::make_shared<futureDetail::State<T>>();
+
+public:
+    Future<T> getFuture() const { return Future<T>(state); }
+
+    // Finishes the future. Must be called once, continuations run on the calling thread
+    template <typename... V>
+    void set(V&&... value) { state->complete(std::forward<V>(value)...); }
+};
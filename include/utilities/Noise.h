@@ -0,0 +1,40 @@
+#pragma once
+
+#include <numeric>
+#include <random>
+#include "utilities/standard.h"
+
+enum NoiseType {
+    NOISE_PERLIN,
+    NOISE_SIMPLEX
+};
+
+// Base class for the gradient noise backends. Owns the seeded permutation table they share
+class Noise {
+protected:
+    // 256 shuffled values, duplicated to avoid overflow
+    std::vector<int> permutation;
+
+    void shufflePermutation(unsigned int seed);
+
+public:
+    Noise();                   // Random seed
+    Noise(unsigned int seed);  // Fixed seed
+
+    virtual ~Noise() {}
+
+    virtual double noise(double x, double y) const = 0;           // 2D noise in [-1, 1]
+    virtual double noise(double x, double y, double z) const = 0; // 3D noise in [-1, 1]
+
+    double octaveNoise(double x, double z, int octaves, double persistence, double scale, Vec2 offset = Vec2(0, 0)) const;
+
+    // Sum of the octaves [firstOctave, lastOctave) of octaveNoise before normalization, 
+    // so low and high octaves can be sampled separately and added up
+    double octaveSum(double x, double z, int firstOctave, int lastOctave, double persistence, double scale, Vec2 offset = Vec2(0, 0)) const;
+
+    // What octaveNoise divides the sum of all its octaves by
+    static double octaveNormalization(int octaves, double persistence);
+
+    // Creates a noise backend of the given type
+    static std::unique_ptr<Noise> create(NoiseType type, unsigned int seed);
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// Bump allocator for temporary buffers, usable by pmr containers. Deallocating does nothing,
+// memory is handed back by rewinding to a mark. Blocks are kept when rewinding, so once the
+// arena has grown to what a piece of work needs, repeating that work does not allocate
+class ScratchArena : public std::pmr::memory_resource {
+public:
+    static const size_t defaultBlockSize = 256 * 1024;
+
+    // Position in the arena to rewind to
+    struct Mark {
+        size_t block = 0;
+        size_t offset = 0;
+    };
+
+    explicit ScratchArena(size_t blockSize = defaultBlockSize) : blockSize(blockSize) {}
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    Mark mark() const { return { block, offset }; }
+
+    // Frees everything allocated since the mark was taken
+    void rewind(const Mark& mark) {
+        block = mark.block;
+        offset = mark.offset;
+    }
+
+    void reset() { rewind(Mark()); }
+
+    // Bytes held in blocks, used or not
+    size_t capacity() const;
+
+    // The arena of the calling thread. Workers rewind it after every task,
+    // on the main thread it holds the scratch of the current frame
+    static ScratchArena& forThread();
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    const size_t blockSize;
+    std::vector<Block> blocks;
+    size_t block = 0;   // block being allocated from
+    size_t offset = 0;  // first free byte in it
+};
+
+// Rewinds an arena to where it was when the scope started
+class ScratchScope {
+public:
+    explicit ScratchScope(ScratchArena& arena = ScratchArena::forThread()) : arena(arena), mark(arena.mark()) {}
+    ~ScratchScope() { arena.rewind(mark); }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    ScratchArena& getArena() const { return arena; }
+
+private:
+    ScratchArena& arena;
+    ScratchArena::Mark mark;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Same output as std::seed_seq for a fixed number of values, without the vector std::seed_seq 
+// allocates. Follows the generate algorithm of the standard, [rand.util.seedseq]
+template <size_t numValues>
+struct SeedSequence {
+    using result_type = uint32_t;
+    uint32_t values[numValues];
+
+    template <typename It>
+    void generate(It begin, It end) const {
+        if (begin == end) return;
+        std::fill(begin, end, 0x8b8b8b8bu);
+        const size_t n = end - begin, s = numValues;
+        const size_t t = n >= 623 ? 11 : n >= 68 ? 7 : n >= 39 ? 5 : n >= 7 ? 3 : (n - 1) / 2;
+        const size_t p = (n - t) / 2, q = p + t, m = std::max(s + 1, n);
+        auto mixBits = [](uint32_t x) { return x ^ (x >> 27); };
+        for (size_t k = 0; k < m; k++) {
+            uint32_t r1 = 1664525u * mixBits(begin[k % n] ^ begin[(k + p) % n] ^ begin[(k + n - 1) % n]);
+            uint32_t r2 = r1 + (k == 0 ? (uint32_t)s : k <= s ? (uint32_t)(k % n) + values[k - 1] : (uint32_t)(k % n));
+            begin[(k + p) % n] += r1;
+            begin[(k + q) % n] += r2;
+            begin[k % n] = r2;
+        }
+        for (size_t k = m; k < m + n; k++) {
+            uint32_t r3 = 1566083941u * mixBits(begin[k % n] + begin[(k + p) % n] + begin[(k + n - 1) % n]);
+            uint32_t r4 = r3 - (uint32_t)(k % n);
+            begin[(k + p) % n] ^= r3;
+            begin[(k + q) % n] ^= r4;
+            begin[k % n] = r4;
+        }
+    }
+};
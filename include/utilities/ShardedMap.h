@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+
+// Hash map that any thread can use. Keys are spread over shards by hash and every shard has
+// its own reader-writer lock, so lookups only take a shared lock on one shard and threads
+// working on different keys rarely wait on each other. Values are only reached through
+// callbacks run under the shard's lock, so a value can not be erased while it is used
+template <typename Key, typename Value, typename Hash, int shardBits = 4>
+class ShardedMap {
+private:
+    static const int numShards = 1 << shardBits;
+
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, Value, Hash> map;
+    };
+    Shard shards[numShards];
+
+    // The map in the shard uses the low bits of the hash, the shard is picked by the high bits
+    static int shardIndex(const Key& key) {
+        uint64_t hash = (uint64_t)Hash()(key) * 0x9E3779B97F4A7C15ULL;
+        return hash >> (64 - shardBits);
+    }
+
+public:
+    // Calls read(const Value&) under a shared lock if the key is in the map. Returns whether it was
+    template <typename F>
+    bool read(const Key& key, F&& read) const {
+        const Shard& shard = shards[shardIndex(key)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) return false;
+        read(it->second);
+        return true;
+    }
+
+    // Calls update(Value&) under an exclusive lock, inserting a default value first if the key is new
+    template <typename F>
+    void update(const Key& key, F&& update) {
+        Shard& shard = shards[shardIndex(key)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        update(shard.map[key]);
+    }
+
+    void insert(const Key& key, Value value) {
+        Shard& shard = shards[shardIndex(key)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.map[key] = std::move(value);
+    }
+
+    // Removes the key and moves its value out. Returns false if the key was not in the map
+    bool take(const Key& key, Value& value) {
+        Shard& shard = shards[shardIndex(key)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it == shard.map.end()) return false;
+        value = std::move(it->second);
+        shard.map.erase(it);
+        return true;
+    }
+
+    bool erase(const Key& key) {
+        Shard& shard = shards[shardIndex(key)];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return shard.map.erase(key) > 0;
+    }
+
+    // Calls read(const Key&, const Value&) for every entry, one shard at a time under its shared lock.
+    // The map must not be changed from inside the callback
+    template <typename F>
+    void forEach(F&& read) const {
+        for (const Shard& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (const auto& [key, value] : shard.map) {
+                read(key, value);
+            }
+        }
+    }
+
+    size_t size() const {
+        size_t size = 0;
+        for (const Shard& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            size += shard.map.size();
+        }
+        return size;
+    }
+};
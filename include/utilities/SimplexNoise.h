@@ -0,0 +1,19 @@
+#pragma once
+
+#include "utilities/Noise.h"
+
+// Simplex noise on a skewed lattice. Evaluates 3 gradients in 2D and 4 in 3D,
+// compared to 4 and 8 for Perlin noise
+class SimplexNoise : public Noise {
+public:
+    SimplexNoise();                   // Random seed
+    SimplexNoise(unsigned int seed);  // Fixed seed
+
+    double noise(double x, double y) const override;           // 2D Simplex Noise
+    double noise(double x, double y, double z) const override; // 3D Simplex Noise
+
+private:
+    int fastFloor(double x) const;
+    double corner(int hash, double x, double y) const;           // Contribution of a 2D corner
+    double corner(int hash, double x, double y, double z) const; // Contribution of a 3D corner
+};
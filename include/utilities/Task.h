@@ -0,0 +1,170 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// A move-only void() callable. Callables up to inlineSize bytes are stored inside the task,
+// so creating, queueing and running one does not allocate. Larger ones fall back to the heap
+class Task {
+public:
+    static const size_t inlineSize = 48;
+
+    Task() = default;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& callable) {
+        using Callable = std::decay_t<F>;
+        if constexpr (fitsInline<Callable>()) {
+            new (storage) Callable(std::forward<F>(callable));
+            ops = &InlineOps<Callable>::ops;
+        } else {
+            *reinterpret_cast<Callable**>(storage) = new Callable(std::forward<F>(callable));
+            ops = &HeapOps<Callable>::ops;
+        }
+    }
+
+    Task(Task&& other) noexcept {
+        moveFrom(other);
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    void operator()() { ops->invoke(storage); }
+
+    explicit operator bool() const { return ops != nullptr; }
+
+    // Destroys the callable, leaving the task empty
+    void reset() {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*relocate)(void* destination, void* source);  // move constructs and destroys the source
+        void (*destroy)(void* storage);
+    };
+
+    template <typename Callable>
+    static constexpr bool fitsInline() {
+        return sizeof(Callable) <= inlineSize && alignof(Callable) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Callable>;
+    }
+
+    template <typename Callable>
+    struct InlineOps {
+        static void invoke(void* storage) { (*static_cast<Callable*>(storage))(); }
+        static void relocate(void* destination, void* source) {
+            Callable* callable = static_cast<Callable*>(source);
+            new (destination) Callable(std::move(*callable));
+            callable->~Callable();
+        }
+        static void destroy(void* storage) { static_cast<Callable*>(storage)->~Callable(); }
+        static constexpr Ops ops = { invoke, relocate, destroy };
+    };
+
+    template <typename Callable>
+    struct HeapOps {
+        static void invoke(void* storage) { (**static_cast<Callable**>(storage))(); }
+        static void relocate(void* destination, void* source) {
+            *static_cast<Callable**>(destination) = *static_cast<Callable**>(source);
+        }
+        static void destroy(void* storage) { delete *static_cast<Callable**>(storage); }
+        static constexpr Ops ops = { invoke, relocate, destroy };
+    };
+
+    void moveFrom(Task& other) {
+        if (other.ops) {
+            other.ops->relocate(storage, other.storage);
+            ops = other.ops;
+            other.ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage[inlineSize];
+    const Ops* ops = nullptr;
+};
+
+// What a task does, the thread pool keeps its statistics per category
+enum TaskCategory {
+    TASK_GENERAL,
+    TASK_COLUMN,    // climate of a tile of chunk columns
+    TASK_TERRAIN,   // terrain and caves of a chunk
+    TASK_FEATURES,  // trees and rocks of a chunk, added by its terrain task
+    TASK_CATEGORY_COUNT
+};
+
+// A task waiting in a queue, with the category and time it was added in nanoseconds.
+// The group counter, if any, is decremented once the task ran and was counted
+struct QueuedTask {
+    Task task;
+    TaskCategory category = TASK_GENERAL;
+    long long queuedAt = 0;
+    std::atomic<int>* group = nullptr;
+};
+
+// A double ended ring of tasks with preallocated slots. Only grows, by doubling, when it is full
+class TaskRing {
+private:
+    std::vector<QueuedTask> slots;
+    size_t head = 0;    // index of the front task
+    size_t count = 0;
+
+    size_t slot(size_t i) const { return (head + i) & (slots.size() - 1); }
+
+    void grow() {
+        std::vector<QueuedTask> bigger(slots.size() * 2);
+        for (size_t i = 0; i < count; i++) {
+            bigger[i] = std::move(slots[slot(i)]);
+        }
+        slots.swap(bigger);
+        head = 0;
+    }
+
+public:
+    // The capacity is rounded up to a power of two
+    explicit TaskRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size *= 2;
+        slots.resize(size);
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void pushBack(QueuedTask&& task) {
+        if (count == slots.size()) grow();
+        slots[slot(count)] = std::move(task);
+        count++;
+    }
+
+    QueuedTask popBack() {
+        count--;
+        return std::move(slots[slot(count)]);
+    }
+
+    QueuedTask popFront() {
+        QueuedTask task = std::move(slots[head]);
+        head = slot(1);
+        count--;
+        return task;
+    }
+};
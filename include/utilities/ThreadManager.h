@@ -1,38 +1,196 @@
 #pragma once
 
 #include <thread>
-#include <queue>
 #include <vector>
+#include <deque>
+#include <memory>
 #include <functional>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include "utilities/Task.h"
+#include "utilities/MPMCQueue.h"
+#include "utilities/Future.h"
+
+// Snapshot of the pool's telemetry since it was created or last reset
+struct ThreadPoolStats {
+    struct Category {
+        long long tasks = 0;        // tasks that finished running
+        double averageWaitMs = 0.0; // from being added to starting, of the timed tasks
+        double maxWaitMs = 0.0;
+        double averageRunMs = 0.0;  // of the timed tasks
+    };
+    Category categories[TASK_CATEGORY_COUNT];
+
+    // Fraction of the time each worker was awake running or taking tasks, the rest it slept
+    std::vector<double> workerBusy;
+
+    // Tasks added but not yet started, now and at most
+    int queueDepth = 0;
+    int peakQueueDepth = 0;
+
+    double seconds = 0.0;
+};
 
 class ThreadManager {
 public:
     ThreadManager(size_t numThreads);
     ~ThreadManager();
 
-    // Add a new task to the queue
-    void addTask(const std::function<void()>& task);
+    // Add a new task. Tasks added from a worker go to that worker's own queue, others
+    // to a shared lock free queue, or a locked overflow queue when that is full. 
+    // Small lambdas are stored inline in the task, so adding one does not allocate
+    void addTask(Task task, TaskCategory category = TASK_GENERAL) { addTask(std::move(task), category, nullptr); }
+
+    // Runs f on the pool and returns a future for what it returns
+    template <typename F>
+    auto submit(F&& f, TaskCategory category = TASK_GENERAL) -> Future<std::invoke_result_t<std::decay_t<F>&>> {
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+        Promise<R> promise;
+        Future<R> future = promise.getFuture();
+        addTask([promise, f = std::forward<F>(f)]() mutable {
+            if constexpr (std::is_void_v<R>) {
+                f();
+                promise.set();
+            } else {
+                promise.set(f());
+            }
+        }, category);
+        return future;
+    }
+
+    size_t getNumThreads() const { return threads.size(); }
+
+    // Runs one queued task on the calling thread. Returns false if there was none
+    bool runPendingTask();
+
+    // Splits [begin, end) into ranges of at most grainSize and calls body(rangeBegin, rangeEnd) 
+    // for each on the pool. The calling thread helps and returns once every range is done
+    void parallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body);
+
+    // Runs the tasks on the pool and returns once all of them finished, helping with the work
+    void runBatch(std::vector<Task>& tasks);
 
     // Gracefully shut down the thread pool
     void shutdown();
 
+    // Counters are updated with relaxed atomics as tasks run, so they are cheap enough 
+    // to leave on. A task that is running while they are read is not counted yet.
+    // Wait and run times are sampled, see timedTaskInterval
+    ThreadPoolStats getStats() const;
+    void resetStats();
+
 private:
-    // Worker threads
+    friend class TaskGroup;
+
+    // Adds a task that decrements group once it ran and its statistics were recorded
+    void addTask(Task task, TaskCategory category, std::atomic<int>* group);
+
+    // Slots preallocated per worker for the tasks its tasks add, enough to rarely grow
+    static const size_t initialQueueCapacity = 1024;
+
+    // Slots of the queue for tasks added from outside the pool, several frames of border crossings
+    static const size_t submissionCapacity = 4096;
+
+    // Reading the clock costs about as much as adding or taking a task, so only every
+    // this many tasks added by a thread is timed for the wait and run statistics
+    static const unsigned int timedTaskInterval = 8;
+
+    // Telemetry of the tasks run by one thread, on its own cache line
+    struct alignas(64) TaskCounters {
+        std::atomic<long long> tasks[TASK_CATEGORY_COUNT] = {};
+        std::atomic<long long> samples[TASK_CATEGORY_COUNT] = {};
+        std::atomic<long long> waitNs[TASK_CATEGORY_COUNT] = {};
+        std::atomic<long long> maxWaitNs[TASK_CATEGORY_COUNT] = {};
+        std::atomic<long long> runNs[TASK_CATEGORY_COUNT] = {};
+        std::atomic<long long> busyNs = 0;
+    };
+
+    // A worker's tasks. The owner takes from the back, idle workers steal from the front
+    struct WorkerQueue {
+        TaskRing tasks = TaskRing(initialQueueCapacity);
+        std::mutex mutex;
+
+        // Size of tasks, written under the lock and read without it to skip empty queues
+        // and count the pending tasks
+        std::atomic<size_t> size = 0;
+
+        TaskCounters counters;
+    };
+
+    // Worker threads and their queues, by worker index
     std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+    // Tasks run by threads outside the pool while they help
+    TaskCounters helperCounters;
+
+    // Tasks added from outside the pool, taken by any worker without locking
+    MPMCQueue<QueuedTask> submitted = MPMCQueue<QueuedTask>(submissionCapacity);
+
+    // Tasks added from outside the pool while the submission queue is full. A deque, 
+    // so a long burst reuses freed blocks instead of doubling and copying a ring
+    std::mutex overflowMutex;
+    std::deque<QueuedTask> overflow;
+    std::atomic<size_t> overflowSize = 0;
 
-    // Task queue
-    std::queue<std::function<void()>> taskQueue;
+    // Measured when a timed task is added
+    std::atomic<int> peakPendingTasks;
 
-    // Synchronization primitives
-    std::mutex queueMutex;
+    // When the statistics were last reset, in nanoseconds
+    std::atomic<long long> statsStart;
+
+    // Queue where the next thread from outside the pool that helps starts looking
+    std::atomic<unsigned int> nextQueue;
+
+    // Idle workers sleep here until a task is added. Adding a task only takes the lock
+    // and notifies when a worker is asleep and none is already being woken. A woken
+    // worker wakes the next one if there is more work, so a burst of tasks costs the
+    // thread adding them one notify. The count and the flag only change under the lock.
+    // Every add reads them, so they get their own cache line
+    alignas(64) std::mutex sleepMutex;
     std::condition_variable condition;
+    std::atomic<int> sleepingWorkers;
+    std::atomic<bool> waking;
 
     // Atomic flag to stop threads
     std::atomic<bool> stop;
 
+    // Takes a task from the worker's own queue, the submission or overflow queue, or steals one from another worker
+    bool takeTask(size_t workerIndex, QueuedTask& task);
+
+    // Runs a task taken from a queue and records it, with its wait and run time if it is timed.
+    // Returns when a timed task finished, 0 for other tasks
+    long long runTask(QueuedTask& task, TaskCounters& counters);
+
+    // Tasks added but not yet taken, counted from the queues so that adding and taking 
+    // a task do not write a shared counter. Adding makes the size grow with a sequentially
+    // consistent write, which orders it before the adding thread checks for sleeping workers
+    size_t pendingTasks() const;
+
+    // Wakes a sleeping worker, unless none sleeps or one is already being woken
+    void wakeWorker();
+
     // Worker function
-    void workerThread();
+    void workerThread(size_t workerIndex);
+};
+
+// Tasks that can be waited on together. wait() runs queued tasks while it waits, 
+// so it can be called from the main thread as well as from inside a task
+class TaskGroup {
+public:
+    TaskGroup(ThreadManager& threadManager) : threadManager(threadManager), pending(0) {}
+    ~TaskGroup() { wait(); }
+
+    template <typename F>
+    void run(F&& task, TaskCategory category = TASK_GENERAL) {
+        pending++;
+        threadManager.addTask(std::forward<F>(task), category, &pending);
+    }
+
+    void wait();
+
+private:
+    ThreadManager& threadManager;
+    std::atomic<int> pending;
 };
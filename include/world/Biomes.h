@@ -1,5 +1,8 @@
 #pragma once
 
+#include <vector>
+#include <cstdint>
+
 enum BiomeType {
     OCEAN,
     MOUNTAINS,
@@ -8,5 +11,68 @@ enum BiomeType {
     PLAINS,
     FOREST,
     DESSERT,
-    RAINFOREST
+    RAINFOREST,
+    NUM_BIOMES
+};
+
+// A band of material under the surface
+struct BiomeLayer {
+    uint8_t materialID;
+    int depth;           // thickness in voxels
+};
+
+// Data description of a biome. Climate ranges are (min, max], definitions
+// earlier in the list win where ranges overlap. Edges are doubles, so float 
+// climate values compare against them like they did against double literals
+struct BiomeDefinition {
+    BiomeType type;
+    double minHeight, maxHeight;
+    double minHumid, maxHumid;
+    double minTemp, maxTemp;
+    std::vector<BiomeLayer> layers;  // from the surface voxel downwards
+    uint8_t baseMaterial;            // below the layers
+    uint8_t fillMaterial;            // above the surface up to the water level
+    float blendWidth = 0.0f;         // dithered blending across minHeight, 0 for none
+};
+
+// The biomes of the world
+const std::vector<BiomeDefinition>& defaultBiomes();
+
+// Biome definitions compiled into a climate lookup table and per biome layer tables
+class BiomeTable {
+public:
+    static const int maxLayerDepth = 32;
+
+private:
+    std::vector<BiomeDefinition> definitions;
+
+    // Sorted range edges per climate axis, a value's cell is the number of edges below it
+    std::vector<double> heightEdges, humidEdges, tempEdges;
+    std::vector<uint8_t> climateTable;
+
+    // layerTable[biome][depth] for depths 0 to maxLayerDepth, the last entry is the base material
+    uint8_t layerTable[NUM_BIOMES][maxLayerDepth + 1] = {};
+    uint8_t fillTable[NUM_BIOMES] = {};
+
+    int surfaceDepth = 0;
+
+    static int cellIndex(const std::vector<double>& edges, float value);
+
+public:
+    BiomeTable(const std::vector<BiomeDefinition>& definitions);
+
+    // Biome at the given climate
+    BiomeType lookup(float height, float humid, float temp) const;
+
+    // Biome of a column and the biome it blends with, with the chance per voxel of using the blend biome
+    void lookupBlend(float height, float humid, float temp, BiomeType& biome, BiomeType& blendBiome, float& blendChance) const;
+
+    // Material at a depth below the surface. Negative depths are above the surface
+    inline uint8_t material(BiomeType biome, int depth) const {
+        if (depth < 0) return fillTable[biome];
+        return layerTable[biome][depth < maxLayerDepth ? depth : maxLayerDepth];
+    }
+
+    // Deepest depth of any biome that is not its base material
+    int getSurfaceDepth() const { return surfaceDepth; }
 };
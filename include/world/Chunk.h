@@ -5,17 +5,22 @@
 #include "rendering/Mesh.h"
 #include <unordered_set>
 #include <functional>
+#include <atomic>
 
 #define CHUNKSIZE 16
 
 struct ColumnData {
     BiomeType biome;
+    BiomeType blendBiome;
+    float blendChance;  // chance per voxel of using the blend biome
     int worldHeight;
     float height;
     float humidity;
     float temperature;
 };
 
+class Chunk;
+
 class ChunkColumn {
     static const int size = CHUNKSIZE;
 
@@ -26,6 +31,17 @@ public:
 
     int dependencyCount = 0;
 
+    // Lowest and highest surface height in the column
+    int minHeight = 0;
+    int maxHeight = 0;
+
+    // Climate is generated on a worker, chunks in the column wait for it
+    bool isGenerated = false;
+    std::vector<Chunk*> waitingChunks;
+
+    // Link in the world manager's completion stack
+    ChunkColumn* nextCompleted = nullptr;
+
     ChunkColumn(const Vec2& worldPosition2D)
         : worldPosition2D(worldPosition2D) {}
 
@@ -40,10 +56,23 @@ public:
     }
 };
 
+// Ownership of a chunk as seen by the main thread. Only the main thread changes it, with release
+// stores, so a thread that loads DONE with acquire also sees the finished voxels
 enum ChunkState {
-    PENDING,
-    GENERATED,
-    DONE
+    PENDING,    // waiting for its column or in the generation queue
+    GENERATING, // being generated on a worker
+    GENERATED,  // terrain, caves and features done, waiting for its neighbours' writes
+    DONE        // ready to upload
+};
+
+// Generation stages in order. A chunk's stage is the last one it completed
+enum ChunkStage {
+    STAGE_NONE,
+    STAGE_COLUMN,       // column climate is available
+    STAGE_TERRAIN,
+    STAGE_CAVES,
+    STAGE_FEATURES,     
+    STAGE_UPLOAD_READY  // all loaded neighbours finished features and their writes are applied
 };
 
 class Chunk {
@@ -60,21 +89,59 @@ public:
 
     Voxel voxels[numVoxels];
 
-    ChunkState state = PENDING;
+    std::atomic<ChunkState> state = PENDING;
+    ChunkStage stage = STAGE_NONE;
+
+    // Loaded neighbours that have not finished their features yet. Finishing waits for zero
+    int pendingNeighbours = 0;
+
+    // Set by the main thread when the chunk is unloaded while generating,
+    // the worker checks it between stages and stops early
+    std::atomic<bool> cancelled = false;
+
+    // Link in the world manager's completion stack
+    Chunk* nextCompleted = nullptr;
+
+    // Loaded chunks of the 3x3x3 block around this one, indexed by neighbourIndex, with this
+    // chunk in the middle. Kept by the main thread on load and unload, only it may follow them
+    static const int numNeighbours = 27;
+    static const int selfIndex = 13;
+    Chunk* neighbours[numNeighbours] = {};
 
     bool isEmpty = true;
     bool isDirty = true;
 
+    // Uploads are spread over frames, the chunk is drawn once its voxels reached the GPU
+    bool isUploaded = false;
+    bool uploadQueued = false;
+
     Chunk(Vec3 worldPosition, int bufferOffset) 
-        : worldPosition(worldPosition), bufferOffset(bufferOffset) {}
+        : worldPosition(worldPosition), bufferOffset(bufferOffset) {
+        neighbours[selfIndex] = this;
+    }
+
+    // Index in neighbours of the chunk offset by -1, 0 or 1 chunks on each axis
+    static int neighbourIndex(int dx, int dy, int dz) { return (dx + 1) + (dy + 1) * 3 + (dz + 1) * 9; }
+
+    // The index of this chunk in the neighbour at neighbourIndex
+    static int oppositeIndex(int index) { return numNeighbours - 1 - index; }
+
+    Chunk* getNeighbour(int dx, int dy, int dz) const { return neighbours[neighbourIndex(dx, dy, dz)]; }
 
     ~Chunk() {}
 
+    // Fills every voxel of the chunk
+    void fill(const Voxel& voxel);
+
     // voxel manipulation
     bool addVoxel(const Vec3& localPosition, const Voxel& newVoxel);
     bool removeVoxel(const Vec3& localPosition);    
     Voxel* getVoxel(const Vec3& localPosition);
 
+    // Same, but the position may be up to one chunk outside, it is then read from the neighbour.
+    // Returns null if that neighbour is not loaded or the position is further away
+    Voxel* getVoxelNear(const Vec3& localPosition);
+
     // Bounds checking
     bool positionInBounds(const Vec3& localPosition) const;
     bool positionIsEdge(const Vec3& localPosition) const; 
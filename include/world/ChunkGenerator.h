@@ -1,57 +1,132 @@
 #pragma once
 
-#include "utilities/PerlinNoise.h"
+#include <atomic>
+#include <chrono>
+#include "utilities/Noise.h"
+#include "utilities/DensityField.h"
 #include "Chunk.h"
 #include "Biomes.h"
+#include "Prefab.h"
 
 class WorldManager;
 
+// Time spent in each generation stage, summed over all workers
+struct GenerationStats {
+    std::atomic<long long> nanoseconds[STAGE_UPLOAD_READY + 1] = {};
+    std::atomic<int> count[STAGE_UPLOAD_READY + 1] = {};
+
+    // Adds the time since start to the stage and returns the current time
+    std::chrono::steady_clock::time_point record(ChunkStage stage, std::chrono::steady_clock::time_point start, int calls = 1);
+
+    // Average milliseconds per call of the stage
+    double averageMs(ChunkStage stage) const;
+
+    void reset();
+};
+
 class ChunkGenerator {
 private:
     const int waterHeight = 112;
+
+    // Biome definitions compiled into lookup tables
+    const BiomeTable biomeTable = BiomeTable(defaultBiomes());
+
+    // Trees and rocks placed by generateFeatures
+    const PrefabLibrary prefabs;
     
     WorldManager& worldManager;
     
-    PerlinNoise perlin;
-    std::mt19937 rng;
+    std::unique_ptr<Noise> noise;
+    unsigned int seed;
+
+    // Cave density is sampled on a coarse lattice and interpolated
+    DensityField caveField;
+    const float caveThreshold = -0.4;
+
+    // Sky layers, only evaluated in chunks that overlap their altitude band
+    const int islandMinHeight = 232, islandMaxHeight = 280;
+    const int cloudMinHeight = 296, cloudMaxHeight = 312;
+    DensityField skyField = DensityField(4);
 
     static const int chunkSize = CHUNKSIZE;
 
-    // Generates a biome from 2D world position and height
-    BiomeType getBiome(float height, float humid, float temp);
+    // Column noise octaves with wavelengths of a hundred voxels or more are sampled once per
+    // tile on a coarse grid and interpolated. The grid is aligned to the world, so a column
+    // gets the same climate whichever tile it is generated in
+    static const int tileGridStep = 8;
+    static const int heightCoarseOctaves = 3;
+    static const int mountainCoarseOctaves = 2;
+    static_assert(CHUNKSIZE % tileGridStep == 0, "columns must start on the coarse grid");
+
+    // Low octave sums of the column noise at one point
+    struct CoarseClimate {
+        double height, mountain, humidity, temperature;
+    };
 
-    // Generates height at the 2D world position
-    float generateHeight(const Vec2& worldPosition2D);
+    CoarseClimate sampleCoarseClimate(double x, double z) const;
 
-    // Generates a voxel based on position, biome and height
-    Voxel generateVoxel(const Vec3& worldPosition, BiomeType biome, int worldHeight);
+    // Generates height at the 2D world position, given the low octaves there
+    float generateHeight(const Vec2& worldPosition2D, const CoarseClimate& coarse) const;
 
-    // Generates a tree
-    void generateTree(const Vec3& worldPosition);
+    // Returns a random engine that only depends on the seed, the chunk and the salt,
+    // so chunks generate the same regardless of which thread runs them
+    std::mt19937 chunkRandom(const Vec3& chunkWorldPosition, unsigned int salt) const;
+
+    // Stamps a prefab with its anchor at the world position. The part inside the chunk 
+    // is written directly, the parts in neighbours are deferred with one batch per neighbour
+    void stampPrefab(Chunk* chunk, const Prefab& prefab, const Vec3& worldPosition);
+
+    // Generates the surface terrain of a chunk from its column
+    void generateTerrain(Chunk* chunk, ChunkColumn* column);
 
     // Generates caves
     void generateChunk3D(Chunk* chunk);
 
+    // Generates floating islands and clouds
+    void generateSky(Chunk* chunk);
+
+    // Density of the sky layers, positive is solid
+    double islandDensity(double x, double y, double z) const;
+    double cloudDensity(double x, double y, double z) const;
+
 public:
-    ChunkGenerator(WorldManager& worldManager) 
+    ChunkGenerator(WorldManager& worldManager, NoiseType noiseType = NOISE_PERLIN) 
         : worldManager(worldManager) {
             std::random_device rd;
-            unsigned int seed = rd();
-            perlin = PerlinNoise(seed);
-            rng = std::mt19937(seed);
+            seed = rd();
+            noise = Noise::create(noiseType, seed);
         }
 
-    ChunkGenerator(WorldManager& worldManager, unsigned int seed) 
-        : worldManager(worldManager) {
-            perlin = PerlinNoise(seed);
-            rng = std::mt19937(seed);
+    ChunkGenerator(WorldManager& worldManager, unsigned int seed, NoiseType noiseType = NOISE_PERLIN) 
+        : worldManager(worldManager), seed(seed) {
+            noise = Noise::create(noiseType, seed);
         }
 
     ~ChunkGenerator() {}
 
-    void generateChunk(Chunk* chunk);
+    // Per stage timings of every chunk and column generated so far
+    GenerationStats stats;
 
-    void generateFeatures(Chunk* chunk);
+    // Runs the terrain, caves and features stages from the chunk's generated column. Safe to run 
+    // on a worker thread, features that spill into neighbours are deferred through the world manager.
+    // Returns early once the chunk is cancelled
+    void generateChunk(Chunk* chunk, ChunkColumn* column);
+
+    // The two halves of generateChunk, so they can run as separate tasks. The terrain half
+    // runs the terrain and caves stages and returns false if the chunk was cancelled
+    bool generateChunkTerrain(Chunk* chunk, ChunkColumn* column);
+    void generateChunkFeatures(Chunk* chunk, ChunkColumn* column);
+
+    void generateFeatures(Chunk* chunk, ChunkColumn* column);
 
     void generateChunkColumn(ChunkColumn* column);
+
+    // Generates a group of nearby columns, sharing the low frequency noise between them
+    void generateColumnTile(const std::vector<ChunkColumn*>& columns);
+
+    // Sets the cave lattice step in voxels. 1 samples every voxel, higher is faster but coarser
+    void setCaveQuality(int latticeStep) { caveField.setLatticeStep(latticeStep); }
+
+    // Fills the cave density of a chunk, indexed like Chunk::voxels
+    void generateCaveDensity(const Vec3& chunkWorldPosition, float* density) const;
 };
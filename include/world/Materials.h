@@ -22,6 +22,7 @@ enum MaterialID {
     ID_SAND,
     ID_WATER,
     ID_LEAVES,
+    ID_CLOUD,
 };
 
 const Material air = Material();
@@ -35,6 +36,7 @@ const Material snow = Material(Vec4(1.0, 1.0, 1.0, 1.0));
 const Material sand = Material(Vec4(1.0, 1.0, 0.0, 1.0));
 const Material water = Material(Vec4(0.2, 0.2, 1.0, 0.5), 1.0);
 const Material leaves = Material(Vec4(0.2, 0.6, 0.2, 1.0));
+const Material cloud = Material(Vec4(1.0, 1.0, 1.0, 0.6));
 
 static Material materials[256] = {
     air,
@@ -47,5 +49,6 @@ static Material materials[256] = {
     snow,
     sand,
     water,
-    leaves
+    leaves,
+    cloud
 };
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Voxel.h"
+#include "Biomes.h"
+
+// A voxel of a prefab, relative to its anchor
+struct PrefabCell {
+    int8_t x, y, z;
+    uint8_t paletteIndex;
+};
+
+// A small voxel structure like a tree or a rock, stamped into the world as a whole.
+// Built as a dense block of palette indices and compiled to a sparse list of cells
+class Prefab {
+private:
+    std::vector<uint8_t> blocks;   // x + y * size.x + z * size.x * size.y, 0 is empty
+
+public:
+    Vec3 size;                     // dimensions of the block, at most 127 per axis
+    Vec3 anchor;                   // block position placed at the stamp position
+    std::vector<Voxel> palette;    // index 0 is empty and never written
+    std::vector<PrefabCell> cells; // non empty voxels, valid after compile()
+
+    Prefab(const Vec3& size, const Vec3& anchor, const std::vector<Voxel>& palette);
+
+    // Block editing
+    void set(const Vec3& blockPosition, uint8_t paletteIndex);
+    void fillBox(const Vec3& min, const Vec3& max, uint8_t paletteIndex);
+
+    // Builds the cell list from the block
+    void compile();
+};
+
+// Prefab variants a biome places on a surface material, one in chance surface voxels
+struct FeatureRule {
+    uint8_t surfaceMaterial;
+    int chance;
+    std::vector<int> variants;     // indices into the library's prefabs
+};
+
+// All prefabs and the rules for placing them per biome
+class PrefabLibrary {
+public:
+    std::vector<Prefab> prefabs;
+    std::vector<FeatureRule> rules[NUM_BIOMES];
+
+    // Trees and rocks of the default biomes
+    PrefabLibrary();
+};
@@ -32,11 +32,12 @@ struct Voxel {
         data |= materialID;
     } 
 
-    inline bool isSolid() {
-        return getMatID() != 0;
+    // Clouds are drawn, but shapes and rays pass through them
+    inline bool isSolid() const {
+        return getMatID() != ID_AIR && getMatID() != ID_CLOUD;
     }
 
-    inline bool isTransparent() {
+    inline bool isTransparent() const {
         return materials[getMatID()].color.a != 1.0;
     }
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Chunk.h"
+
+class WorldManager;
+
+// Reads voxels at nearby world positions. It keeps the chunk it is in and moves with index
+// arithmetic, crossing into neighbours through their links and only looking up chunks that
+// are further away. Uses the neighbour links, so like them it is for the main thread only
+class VoxelCursor {
+private:
+    static const int size = CHUNKSIZE;
+
+    WorldManager& world;
+    Chunk* chunk = nullptr;  // null if the chunk at the cursor is not loaded
+    int chunkX, chunkY, chunkZ;  // chunk position
+    int localX, localY, localZ;  // voxel position in that chunk
+
+    // Finds the chunk after the local position left it
+    void changeChunk();
+
+public:
+    VoxelCursor(WorldManager& world, const Vec3& worldPosition);
+
+    // Moves by whole voxels
+    void move(int dx, int dy, int dz);
+
+    // Moves to the voxel containing the world position
+    void moveTo(const Vec3& worldPosition);
+
+    Vec3 getPosition() const;
+
+    // The voxel at the cursor, null if its chunk is not loaded
+    Voxel* get() const { return chunk ? &chunk->voxels[localX + localY * size + localZ * size * size] : nullptr; }
+
+    // Same as the world manager's checks, unloaded voxels are air
+    bool isSolid() const;
+};
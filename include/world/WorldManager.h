@@ -1,28 +1,150 @@
 #pragma once
 
+#include <queue>
 #include "ChunkGenerator.h"
 #include "physics/AABB.h"
 #include "utilities/ThreadManager.h"
+#include "utilities/CompletionStack.h"
+#include "utilities/FrameJobQueue.h"
+#include "utilities/ShardedMap.h"
+#include "rendering/Camera.h"
+
+// A voxel write from a feature that landed outside the chunk generating it
+struct PendingWrite {
+    Vec3 localPosition;
+    Voxel voxel;
+};
 
 class WorldManager {
 private:
     const int chunkSize = CHUNKSIZE;
 
-    std::unordered_map<Vec3, std::unique_ptr<Chunk>, Vec3Hash> activeChunks;   
-    std::unordered_map<Vec2, std::unique_ptr<ChunkColumn>, Vec2Hash> activeColumns;
+    // Loaded chunks and columns by chunk position. Only the main thread adds and removes them,
+    // any thread can look up chunks through findChunk. Chunks are shared so a lookup from another 
+    // thread, or a chunk cancelled while generating, keeps its chunk until it lets go
+    ShardedMap<Vec3, std::shared_ptr<Chunk>, Vec3Hash> activeChunks;
+    ShardedMap<Vec2, std::unique_ptr<ChunkColumn>, Vec2Hash> activeColumns;
     std::queue<int> availableOffsets;
 
+    // Deferred feature writes keyed by target chunk position. Written by workers,
+    // applied by the main thread once the target chunk is no longer being generated
+    ShardedMap<Vec3, std::vector<PendingWrite>, Vec3Hash> pendingWrites;
+
+    // Chunks that got their first pending write since the last update
+    std::vector<Vec3> pendingTargets;
+    std::mutex pendingMutex;
+
+    // Work finished by workers, handed to the main thread without locking
+    CompletionStack<ChunkColumn> completedColumns;
+    CompletionStack<Chunk> completedChunks;
+
+    // Chunks whose neighbours all finished their features, drained every update
+    std::vector<Chunk*> finishQueue;
+
+    // Main thread work over a frame budget. Without it chunks are finished in the update
+    FrameJobQueue* frameJobs = nullptr;
+
+    // Promises of whenChunkDone by chunk position, kept until the chunk is done or unloaded
+    std::unordered_map<Vec3, std::vector<Promise<bool>>, Vec3Hash> chunkWaiters;
+
+    // Columns created this update, generated in tiles of columnTileSize x columnTileSize
+    static const int columnTileSize = 4;
+    std::vector<ChunkColumn*> newColumns;
+
+    // A chunk whose column is ready, waiting for a worker
+    struct QueuedChunk {
+        Chunk* chunk;
+        ChunkColumn* column;
+    };
+
+    // Chunks scheduled since the last update, ranked into the generation queue by the next one
+    std::vector<QueuedChunk> scheduledChunks;
+
+    // Queued chunks ranked by every update, the best at the back. A few generation slots per
+    // worker each take the best chunk, generate it and then take the next, so workers refill
+    // as they finish instead of once per update. Guarded by generationMutex, like the slot
+    // count and the move of a queued chunk to GENERATING
+    static const int generationSlotsPerThread = 2;
+    std::vector<QueuedChunk> generationQueue;
+    int generationSlots = 0;
+    std::mutex generationMutex;
+
+    // Chunks unloaded while a worker was generating them, freed once the worker reports back
+    std::vector<std::shared_ptr<Chunk>> cancelledChunks;
+
+    // Box of chunk positions loaded by the last update. Nothing is loaded or unloaded
+    // until the center moves to another chunk
+    AABB lastActiveBox;
+    bool hasActiveBox = false;
+
+    // Chunk slots of the active box left empty because no buffer slot was free
+    int missingChunks = 0;
+
+    // The flat chunk array is rebuilt here and swapped when the active box moves
+    Chunk** shiftedChunks;
+
+    // Columns that left the active box, removed once no chunk or tile task uses them
+    std::vector<Vec2> staleColumns;
+
+    // Tasks handed to the thread manager that have not finished, waited on before destruction
+    std::atomic<int> tasksRunning = 0;
+
     ChunkGenerator chunkGenerator;
     ThreadManager& threadManager;
 
+    // Allocates the flat chunk array and the buffer offsets for every chunk slot
+    void initChunkSlots();
+
     // position converters
     Vec3 worldToChunkPosition(const Vec3& worldPosition) const;
     
-    // Chunk management
+    // Chunk management. Lookups are main thread only, the chunk can be freed by the next update
     Chunk* addChunk(const Vec3& chunkPosition, int bufferOffset);
     Chunk* getChunk(const Vec3& chunkPosition) const;
     ChunkColumn* addColumn(Vec2 columnPosition);
-    bool neighboursReady(Chunk* chunk);
+
+    // Unloads the slabs that left the box, loads the ones that entered and shifts the flat chunk array
+    void moveActiveBox(const AABB& activeBox);
+    void removeStaleColumns(const AABB2D& activeBox2D);
+
+    // Index in the flat chunk array of a chunk position in the box
+    int chunkIndex(const Vec3& chunkPosition, const AABB& box) const;
+
+    // Generation pipeline: column -> terrain, caves, features -> neighbours' writes -> upload ready
+    void loadChunk(const Vec3& chunkPosition, int bufferOffset);
+    void unloadChunk(Chunk* chunk, const AABB& activeBox);
+    void scheduleColumnTiles();
+    void scheduleChunk(Chunk* chunk);
+
+    // Ranks the queued chunks by priority and starts generation slots for them
+    void dispatchGeneration(const Vec3& viewPosition, const Camera* camera);
+
+    // Runs on a worker, generates the best queued chunk and hands the slot on, or ends it
+    void generateNextChunk();
+    void processCompletions();
+    void processFinishQueue();
+
+    // Applies the deferred writes of a chunk whose neighbours all finished and marks it done
+    void finishChunk(Chunk* chunk);
+
+    // Finishes the futures handed out by whenChunkDone for the chunk position
+    void notifyChunkWaiters(const Vec3& chunkPosition, bool isDone);
+
+    // Calls the callback for every loaded chunk in the 3x3x3 block around the chunk
+    void forEachNeighbour(Chunk* chunk, const std::function<void(Chunk*)>& callback);
+
+    // Connects a loaded chunk with its loaded neighbours, and disconnects it again on unload
+    void linkNeighbours(Chunk* chunk, const Vec3& chunkPosition);
+    void unlinkNeighbours(Chunk* chunk);
+
+    // Applies and clears the deferred writes for a chunk that no worker is using
+    void applyPendingWrites(Chunk* chunk);
+
+    // Applies new deferred writes to finished chunks and drops writes for far away chunks
+    void updatePendingWrites(const AABB& activeBox);
+
+    // Shared by both updateChunks, the camera is optional
+    void updateChunksAround(const Vec3& worldCenter, const Camera* camera);
 
 public:
     int updateDistance = 4;
@@ -33,22 +155,48 @@ public:
     
     WorldManager(ThreadManager& threadManager, int updateDistance)
         : updateDistance(updateDistance), threadManager(threadManager), chunkGenerator(*this) {
-        int worldEdgeLen = updateDistance * 2 + 1;
-        numChunks = worldEdgeLen * worldEdgeLen * worldEdgeLen;
-        chunks = new Chunk*[numChunks]();
-        int numVoxels = chunkSize * chunkSize * chunkSize;
-        for (int i = 0; i < numChunks; i++) {
-            int offset = i * numVoxels;
-            availableOffsets.push(offset);
-        }
+        initChunkSlots();
     }
 
-    // Updates all chunks in the a set range of the camera
+    // World with a fixed seed and noise backend, so runs can be reproduced and compared
+    WorldManager(ThreadManager& threadManager, int updateDistance, unsigned int seed, NoiseType noiseType = NOISE_PERLIN)
+        : chunkGenerator(*this, seed, noiseType), threadManager(threadManager), updateDistance(updateDistance) {
+        initChunkSlots();
+    }
+
+    // Waits for the tasks still running on the thread manager
+    ~WorldManager();
+
+    // Updates all chunks in the a set range of the world center, generating the closest first
     void updateChunks(Vec3 worldCenter);
 
-    // Get column at the column position. Returns null if invalid
+    // Same, but chunks in the camera's view are generated before the ones behind it
+    void updateChunks(const Camera& camera);
+
+    // Finishing chunks runs as jobs on the queue, spread over frames
+    void setFrameJobs(FrameJobQueue* jobs) { frameJobs = jobs; }
+
+    // Per stage generation timings, summed over all workers
+    const GenerationStats& getGenerationStats() const { return chunkGenerator.stats; }
+
+    // Get column at the column position. Returns null if invalid. Main thread only
     ChunkColumn* getColumn(Vec2 columnPosition) const;
 
+    // Get the loaded chunk containing the world position. Returns null if there is none. 
+    // Main thread only, the chunk can be unloaded by the next update
+    Chunk* getChunkAt(const Vec3& worldPosition) const;
+
+    // Same, for threads other than the main one. The chunk is not freed while the pointer is held
+    std::shared_ptr<Chunk> findChunk(const Vec3& worldPosition) const;
+
+    // Finishes with true once the chunk containing the world position is done, or with false 
+    // if it is not loaded or gets unloaded first. Main thread only, like the update that finishes it
+    Future<bool> whenChunkDone(const Vec3& worldPosition);
+
+    // Records voxel writes for a chunk, with positions local to it. Thread safe, the writes 
+    // are applied when that chunk is generated or, if it already is, on the next update
+    void deferVoxels(const Vec3& chunkPosition, const PendingWrite* writes, size_t count);
+
     // Global voxel operations
     void addVoxel(const Vec3& worldPosition, const Voxel& voxel);
     void removeVoxel(const Vec3& worldPosition);
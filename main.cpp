@@ -86,7 +86,32 @@ void processKeyStates(float deltaTime, Camera& camera) {
         isRunning = false;
 }
 
+// How well the pool and the frame jobs kept up, to size them
+void printThreadStats(const ThreadManager& threadManager, const FrameJobQueue& frameJobs) {
+    ThreadPoolStats poolStats = threadManager.getStats();
+    const char* categoryNames[TASK_CATEGORY_COUNT] = { "general", "column", "terrain", "features" };
+    for (int i = 0; i < TASK_CATEGORY_COUNT; i++) {
+        const ThreadPoolStats::Category& category = poolStats.categories[i];
+        std::cout << categoryNames[i] << " tasks: " << category.tasks << ", wait " << category.averageWaitMs 
+                  << " ms (max " << category.maxWaitMs << "), run " << category.averageRunMs << " ms" << std::endl;
+    }
+    for (size_t i = 0; i < poolStats.workerBusy.size(); i++) {
+        std::cout << "worker " << i << " busy " << poolStats.workerBusy[i] * 100.0 << "%" << std::endl;
+    }
+    std::cout << "peak queue depth " << poolStats.peakQueueDepth << std::endl;
+
+    const FrameJobStats& jobStats = frameJobs.getStats();
+    std::cout << "frame jobs: " << jobStats.deferredFrames << " frames over budget, at most " 
+              << jobStats.peakDeferred << " jobs deferred" << std::endl;
+}
+
 int main(int argc, char* argv[]) {
+    // usage: main [--stats], --stats prints thread pool and frame job statistics on exit
+    bool printStats = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::string(argv[i]) == "--stats") printStats = true;
+    }
+
     // Global instances
     SDL_Window* window = nullptr;
     SDL_GLContext glContext;
@@ -110,10 +135,14 @@ int main(int argc, char* argv[]) {
     );
     */
 
+    // Main thread work from the world and renderer gets 2 ms per frame, the rest waits a frame
+    FrameJobQueue frameJobs(2.0);
+
     ThreadManager threadManager(4);
     WorldManager worldManager(threadManager, 8);
+    worldManager.setFrameJobs(&frameJobs);
     Player player(Vec3(5.0, 140.0, 5.0), worldManager);
-    Renderer renderer(worldManager, player.camera);
+    Renderer renderer(worldManager, player.camera, frameJobs);
 
     PhysicsEngine physicsEngine(worldManager);
     physicsEngine.addShape(&player.shape);
@@ -156,12 +185,17 @@ int main(int argc, char* argv[]) {
         player.processInput();
         physicsEngine.update(deltaTime);
         player.update();
-        worldManager.updateChunks(player.camera.position);
+        worldManager.updateChunks(player.camera);
+        frameJobs.run();
         renderer.render();
 
         SDL_GL_SwapWindow(window);
     }
 
+    if (printStats) {
+        printThreadStats(threadManager, frameJobs);
+    }
+
     // Cleanup
     SDL_GL_DeleteContext(glContext);
     SDL_DestroyWindow(window);
@@ -1,5 +1,6 @@
 #include "physics/PhysicsEngine.h"
 #include "world/WorldManager.h"
+#include "world/VoxelCursor.h"
 
 void PhysicsEngine::addShape(Shape* shape) {
     shapes.push_back(shape);
@@ -14,13 +15,17 @@ void PhysicsEngine::updateShape(Shape* shape, float deltaTime) {
     bool collision = false;
     Vec3 d = shape->dimensions;
     Vec3 min = pNext - (d / 2.0);
-    if (worldManager.positionIsSolid(floor(boxNext.min)) || 
-        worldManager.positionIsSolid(floor(Vec3(min.x + d.x, min.y, min.z))) ||
-        worldManager.positionIsSolid(floor(Vec3(min.x, min.y + d.y, min.z))) ||
-        worldManager.positionIsSolid(floor(Vec3(min.x, min.y, min.z + d.z))) ||
-        worldManager.positionIsSolid(floor(Vec3(min.x + d.x, min.y + d.y, min.z))) ||
-        worldManager.positionIsSolid(floor(min + d))) {   
-        collision = true;
+    const Vec3 corners[6] = { boxNext.min, Vec3(min.x + d.x, min.y, min.z), Vec3(min.x, min.y + d.y, min.z),
+                              Vec3(min.x, min.y, min.z + d.z), Vec3(min.x + d.x, min.y + d.y, min.z), min + d };
+
+    // The corners are a few voxels apart, so one cursor reads them without chunk lookups
+    VoxelCursor cursor(worldManager, corners[0]);
+    for (const Vec3& corner : corners) {
+        cursor.moveTo(corner);
+        if (cursor.isSolid()) {
+            collision = true;
+            break;
+        }
     }
 
     if (collision) {
@@ -52,6 +52,21 @@ void Camera::processMouseInput(float xOffset, float yOffset, float sensitivity)
     isDirty = true;
 }
 
+bool Camera::sphereInView(const Vec3& center, float radius) const {
+    Vec3 toCenter = center - position;
+    float distance = length(toCenter);
+    if (distance <= radius) return true;
+    if (distance - radius > farPlane) return false;
+
+    // The view matrix looks down -front, the cone reaches the corners of the frustum
+    float tanHalfFov = tanf(fov * 0.5f / 180.0f * PI);
+    float aspect = std::max(aspectRatio, 1.0f / aspectRatio);
+    float halfAngle = atanf(tanHalfFov * sqrtf(1.0f + aspect * aspect));
+
+    float angle = acosf(clamp(dot(toCenter, -front) / distance, -1.0f, 1.0f));
+    return angle <= halfAngle + asinf(radius / distance);
+}
+
 void Camera::updateCameraVectors() {
     // Calculate the new front vector
     Vec3 newFront;
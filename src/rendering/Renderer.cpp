@@ -105,19 +105,19 @@ void Renderer::initGLSettings() {
 }
 
 void Renderer::updateWorldBuffers() {
-    int numVoxels = worldManager.chunks[0]->numVoxels;
     int numChunks = worldManager.numChunks;
 
-    // update voxel data
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, voxelBuffer);
+    // queue voxel uploads, the slot of a chunk can change before the job runs so it goes by position
     int chunkOffsets[numChunks];
     for (int i = 0; i < numChunks; i++) {
         auto chunk = worldManager.chunks[i];
-        if (chunk && chunk->isDirty && chunk->state == DONE) {
-            glBufferSubData(GL_SHADER_STORAGE_BUFFER, chunk->bufferOffset * sizeof(Voxel), numVoxels * sizeof(Voxel), chunk->voxels);
-            chunk->isDirty = false;
+        bool isDone = chunk && chunk->state.load(std::memory_order_acquire) == DONE;
+        if (isDone && chunk->isDirty && !chunk->uploadQueued) {
+            chunk->uploadQueued = true;
+            Vec3 worldPosition = chunk->worldPosition;
+            frameJobs.add([this, worldPosition]() { uploadChunk(worldPosition); });
         }
-        if (!chunk || chunk->isEmpty || chunk->state != DONE) {
+        if (!isDone || !chunk->isUploaded || chunk->isEmpty) {
             chunkOffsets[i] = -1;
         } else {
             chunkOffsets[i] = chunk->bufferOffset;
@@ -132,6 +132,20 @@ void Renderer::updateWorldBuffers() {
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 }
 
+void Renderer::uploadChunk(const Vec3& worldPosition) {
+    // A chunk loaded again at the same position may have queued its own upload, either job can do it
+    Chunk* chunk = worldManager.getChunkAt(worldPosition);
+    if (!chunk) return;
+    chunk->uploadQueued = false;
+    if (chunk->state.load(std::memory_order_acquire) != DONE || !chunk->isDirty) return;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, voxelBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, chunk->bufferOffset * sizeof(Voxel), Chunk::numVoxels * sizeof(Voxel), chunk->voxels);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    chunk->isDirty = false;
+    chunk->isUploaded = true;
+}
+
 // Load world buffers based on current settings on update distance/number of chunks
 void Renderer::loadWorldBuffers() {
     int numVoxels = worldManager.chunks[0]->numVoxels;
@@ -0,0 +1,86 @@
+#include "utilities/DensityField.h"
+#include "utilities/ScratchArena.h"
+
+DensityField::DensityField(int latticeStep) {
+    setLatticeStep(latticeStep);
+}
+
+void DensityField::setLatticeStep(int step) {
+    latticeStep = clamp(step, 1, maxLatticeStep);
+}
+
+void DensityField::fill(const Vec3& origin, int sizeX, int sizeY, int sizeZ,
+                        const std::function<double(double, double, double)>& sampler, float* out) const {
+    // Full quality, sample every voxel directly
+    if (latticeStep == 1) {
+        int idx = 0;
+        for (int z = 0; z < sizeZ; z++) {
+            for (int y = 0; y < sizeY; y++) {
+                for (int x = 0; x < sizeX; x++, idx++) {
+                    out[idx] = sampler(origin.x + x, origin.y + y, origin.z + z);
+                }
+            }
+        }
+        return;
+    }
+
+    // Lattice points per axis, the last one lies on or past the far edge of the block
+    int lx = (sizeX - 1) / latticeStep + 2;
+    int ly = (sizeY - 1) / latticeStep + 2;
+    int lz = (sizeZ - 1) / latticeStep + 2;
+
+    ScratchScope scratch;
+    std::pmr::vector<float> lattice(lx * ly * lz, &scratch.getArena());
+    int idx = 0;
+    for (int k = 0; k < lz; k++) {
+        for (int j = 0; j < ly; j++) {
+            for (int i = 0; i < lx; i++, idx++) {
+                lattice[idx] = sampler(origin.x + i * latticeStep, origin.y + j * latticeStep, origin.z + k * latticeStep);
+            }
+        }
+    }
+
+    // The three passes below interpolate one axis at a time, so the inner
+    // loops run over contiguous memory with a constant weight and vectorize
+    float invStep = 1.0f / latticeStep;
+
+    // Pass 1: along x, for every lattice row
+    std::pmr::vector<float> rows(ly * lz * sizeX, &scratch.getArena());
+    for (int row = 0; row < ly * lz; row++) {
+        const float* src = &lattice[row * lx];
+        float* dst = &rows[row * sizeX];
+        for (int x = 0; x < sizeX; x++) {
+            int i = x / latticeStep;
+            float t = (x - i * latticeStep) * invStep;
+            dst[x] = src[i] + t * (src[i + 1] - src[i]);
+        }
+    }
+
+    // Pass 2: along y, for every lattice plane
+    std::pmr::vector<float> planes(lz * sizeY * sizeX, &scratch.getArena());
+    for (int k = 0; k < lz; k++) {
+        for (int y = 0; y < sizeY; y++) {
+            int j = y / latticeStep;
+            float t = (y - j * latticeStep) * invStep;
+            const float* a = &rows[(j + k * ly) * sizeX];
+            const float* b = a + sizeX;
+            float* dst = &planes[(y + k * sizeY) * sizeX];
+            for (int x = 0; x < sizeX; x++) {
+                dst[x] = a[x] + t * (b[x] - a[x]);
+            }
+        }
+    }
+
+    // Pass 3: along z, whole xy slices at once
+    int sliceSize = sizeX * sizeY;
+    for (int z = 0; z < sizeZ; z++) {
+        int k = z / latticeStep;
+        float t = (z - k * latticeStep) * invStep;
+        const float* a = &planes[k * sliceSize];
+        const float* b = a + sliceSize;
+        float* dst = &out[z * sliceSize];
+        for (int i = 0; i < sliceSize; i++) {
+            dst[i] = a[i] + t * (b[i] - a[i]);
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#include "utilities/FrameJobQueue.h"
+#include <algorithm>
+#include <chrono>
+
+void FrameJobQueue::run() {
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration<double, std::milli>(budgetMs);
+
+    {
+        std::lock_guard<std::mutex> lock(incomingMutex);
+        for (Task& job : incoming) {
+            jobs.push_back(std::move(job));
+        }
+        incoming.clear();
+    }
+
+    stats.ran = 0;
+    while (!jobs.empty()) {
+        Task job = std::move(jobs.front());
+        jobs.pop_front();
+        job();
+        stats.ran++;
+
+        if (std::chrono::steady_clock::now() >= deadline) break;
+    }
+
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.deferred = (int)jobs.size();
+    stats.peakDeferred = std::max(stats.peakDeferred, stats.deferred);
+    if (stats.deferred > 0) {
+        stats.deferredFrames++;
+    }
+}
@@ -0,0 +1,75 @@
+#include "utilities/Noise.h"
+#include "utilities/PerlinNoise.h"
+#include "utilities/SimplexNoise.h"
+
+// Default constructor initializes with a random seed
+Noise::Noise() {
+    std::random_device rd;
+    shufflePermutation(rd());
+}
+
+// Constructor with a fixed seed
+Noise::Noise(unsigned int seed) {
+    shufflePermutation(seed);
+}
+
+void Noise::shufflePermutation(unsigned int seed) {
+    permutation.resize(256);
+
+    // Fill the permutation vector with values 0-255
+    std::iota(permutation.begin(), permutation.end(), 0);
+
+    // Shuffle the permutation vector
+    std::default_random_engine engine(seed);
+    std::shuffle(permutation.begin(), permutation.end(), engine);
+
+    // Duplicate the permutation vector to avoid overflow
+    permutation.insert(permutation.end(), permutation.begin(), permutation.end());
+}
+
+double Noise::octaveNoise(double x, double z, int octaves, double persistence, double scale, Vec2 offset) const {
+    // Normalize result to [0, 1]
+    return octaveSum(x, z, 0, octaves, persistence, scale, offset) / octaveNormalization(octaves, persistence);
+}
+
+double Noise::octaveSum(double x, double z, int firstOctave, int lastOctave, double persistence, double scale, Vec2 offset) const {
+    double total = 0.0f;
+    double frequency = 1.0f;
+    double amplitude = 1.0f;
+
+    for (int i = 0; i < lastOctave; i++) {
+        if (i >= firstOctave) {
+            // Add offset to avoid symmetry
+            double nx = (x + offset.x) * frequency * scale;
+            double nz = (z + offset.y) * frequency * scale;
+
+            // Add noise with current frequency and amplitude
+            total += noise(nx, nz) * amplitude;
+        }
+
+        // Increase frequency and decrease amplitude for next octave
+        frequency *= 2.0f;
+        amplitude *= persistence;
+    }
+
+    return total;
+}
+
+double Noise::octaveNormalization(int octaves, double persistence) {
+    double amplitude = 1.0f;
+    double maxAmplitude = 0.0f;
+    for (int i = 0; i < octaves; i++) {
+        amplitude *= persistence;
+        maxAmplitude += amplitude;
+    }
+    return maxAmplitude;
+}
+
+std::unique_ptr<Noise> Noise::create(NoiseType type, unsigned int seed) {
+    switch (type) {
+    case NOISE_SIMPLEX:
+        return std::make_unique<SimplexNoise>(seed);
+    default:
+        return std::make_unique<PerlinNoise>(seed);
+    }
+}
@@ -1,32 +1,10 @@
 #include "utilities/PerlinNoise.h"
 
 // Default constructor initializes with a random seed
-PerlinNoise::PerlinNoise() {
-    permutation.resize(256);
-
-    // Fill the permutation vector with values 0-255
-    std::iota(permutation.begin(), permutation.end(), 0);
-
-    // Shuffle the permutation vector
-    std::random_device rd;
-    std::default_random_engine engine(rd());
-    std::shuffle(permutation.begin(), permutation.end(), engine);
-
-    // Duplicate the permutation vector to avoid overflow
-    permutation.insert(permutation.end(), permutation.begin(), permutation.end());
-}
+PerlinNoise::PerlinNoise() : Noise() {}
 
 // Constructor with a fixed seed
-PerlinNoise::PerlinNoise(unsigned int seed) {
-    permutation.resize(256);
-
-    std::iota(permutation.begin(), permutation.end(), 0);
-
-    std::default_random_engine engine(seed);
-    std::shuffle(permutation.begin(), permutation.end(), engine);
-
-    permutation.insert(permutation.end(), permutation.begin(), permutation.end());
-}
+PerlinNoise::PerlinNoise(unsigned int seed) : Noise(seed) {}
 
 // Fade function (smoothstep)
 double PerlinNoise::fade(double t) const {
@@ -109,27 +87,3 @@ double PerlinNoise::noise(double x, double y, double z) const {
                                   grad(permutation[bbb], x - 1, y - 1, z - 1))));
 }
 
-
-double PerlinNoise::octaveNoise(double x, double z, int octaves, double persistence, double scale, Vec2 offset) {
-    double total = 0.0f;
-    double frequency = 1.0f;
-    double amplitude = 1.0f;
-    double maxAmplitude = 0.0f; // Used for normalization
-
-    for (int i = 0; i < octaves; i++) {
-        // Add offset to avoid symmetry
-        double nx = (x + offset.x) * frequency * scale;
-        double nz = (z + offset.y) * frequency * scale;
-
-        // Add Perlin noise with current frequency and amplitude
-        total += noise(nx, nz) * amplitude;
-
-        // Increase frequency and decrease amplitude for next octave
-        frequency *= 2.0f;
-        amplitude *= persistence;
-        maxAmplitude += amplitude;
-    }
-
-    // Normalize result to [0, 1]
-    return total / maxAmplitude;
-}
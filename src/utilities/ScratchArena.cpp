@@ -0,0 +1,42 @@
+#include "utilities/ScratchArena.h"
+#include <algorithm>
+#include <cstdint>
+
+ScratchArena& ScratchArena::forThread() {
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+size_t ScratchArena::capacity() const {
+    size_t total = 0;
+    for (const Block& b : blocks) {
+        total += b.size;
+    }
+    return total;
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment) {
+    // Try the current block, then the following ones, adding a block when none is left
+    while (true) {
+        if (block < blocks.size()) {
+            Block& current = blocks[block];
+            uintptr_t base = (uintptr_t)current.data.get();
+            size_t aligned = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+            if (aligned + bytes <= current.size) {
+                offset = aligned + bytes;
+                return current.data.get() + aligned;
+            }
+            if (block + 1 < blocks.size()) {
+                block++;
+                offset = 0;
+                continue;
+            }
+        }
+
+        // Large requests get a block of their own size
+        size_t size = std::max(blockSize, bytes + alignment);
+        blocks.push_back({ std::unique_ptr<std::byte[]>(new std::byte[size]), size });
+        block = blocks.size() - 1;
+        offset = 0;
+    }
+}
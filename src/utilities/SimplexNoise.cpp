@@ -0,0 +1,113 @@
+#include "utilities/SimplexNoise.h"
+
+// Gradients along the 12 edges of a cube, 2D noise uses the x and y components
+static const double gradients[12][3] = {
+    { 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+    { 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+    { 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 }
+};
+
+// Skewing factors between the simplex grid and the regular grid
+static const double F2 = 0.5 * (std::sqrt(3.0) - 1.0);
+static const double G2 = (3.0 - std::sqrt(3.0)) / 6.0;
+static const double F3 = 1.0 / 3.0;
+static const double G3 = 1.0 / 6.0;
+
+// Default constructor initializes with a random seed
+SimplexNoise::SimplexNoise() : Noise() {}
+
+// Constructor with a fixed seed
+SimplexNoise::SimplexNoise(unsigned int seed) : Noise(seed) {}
+
+int SimplexNoise::fastFloor(double x) const {
+    int xi = static_cast<int>(x);
+    return x < xi ? xi - 1 : xi;
+}
+
+double SimplexNoise::corner(int hash, double x, double y) const {
+    double t = 0.5 - x * x - y * y;
+    if (t < 0) return 0.0;
+    const double* g = gradients[hash % 12];
+    t *= t;
+    return t * t * (g[0] * x + g[1] * y);
+}
+
+double SimplexNoise::corner(int hash, double x, double y, double z) const {
+    double t = 0.5 - x * x - y * y - z * z;
+    if (t < 0) return 0.0;
+    const double* g = gradients[hash % 12];
+    t *= t;
+    return t * t * (g[0] * x + g[1] * y + g[2] * z);
+}
+
+// 2D Simplex Noise function
+double SimplexNoise::noise(double x, double y) const {
+    // Find the cell of the skewed grid and the position inside it
+    double s = (x + y) * F2;
+    int i = fastFloor(x + s);
+    int j = fastFloor(y + s);
+    double t = (i + j) * G2;
+    double x0 = x - (i - t);
+    double y0 = y - (j - t);
+
+    // The cell is split into two triangles, pick the one containing the point
+    int i1 = x0 > y0 ? 1 : 0;
+    int j1 = 1 - i1;
+
+    double x1 = x0 - i1 + G2;
+    double y1 = y0 - j1 + G2;
+    double x2 = x0 - 1.0 + 2.0 * G2;
+    double y2 = y0 - 1.0 + 2.0 * G2;
+
+    int ii = i & 255; // Wrap to 0-255
+    int jj = j & 255;
+
+    double n = corner(permutation[ii + permutation[jj]], x0, y0)
+             + corner(permutation[ii + i1 + permutation[jj + j1]], x1, y1)
+             + corner(permutation[ii + 1 + permutation[jj + 1]], x2, y2);
+
+    // Scale to [-1, 1]
+    return 70.0 * n;
+}
+
+// 3D Simplex Noise function
+double SimplexNoise::noise(double x, double y, double z) const {
+    // Find the cell of the skewed grid and the position inside it
+    double s = (x + y + z) * F3;
+    int i = fastFloor(x + s);
+    int j = fastFloor(y + s);
+    int k = fastFloor(z + s);
+    double t = (i + j + k) * G3;
+    double x0 = x - (i - t);
+    double y0 = y - (j - t);
+    double z0 = z - (k - t);
+
+    // The cell is split into six tetrahedra, pick the one containing the point
+    int i1, j1, k1; // Offsets of the second corner
+    int i2, j2, k2; // Offsets of the third corner
+    if (x0 >= y0) {
+        if (y0 >= z0)      { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+        else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+        else               { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+    } else {
+        if (y0 < z0)       { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+        else if (x0 < z0)  { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+        else               { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+    }
+
+    double x1 = x0 - i1 + G3,       y1 = y0 - j1 + G3,       z1 = z0 - k1 + G3;
+    double x2 = x0 - i2 + 2.0 * G3, y2 = y0 - j2 + 2.0 * G3, z2 = z0 - k2 + 2.0 * G3;
+    double x3 = x0 - 1.0 + 3.0 * G3, y3 = y0 - 1.0 + 3.0 * G3, z3 = z0 - 1.0 + 3.0 * G3;
+
+    int ii = i & 255; // Wrap to 0-255
+    int jj = j & 255;
+    int kk = k & 255;
+
+    double n = corner(permutation[ii + permutation[jj + permutation[kk]]], x0, y0, z0)
+             + corner(permutation[ii + i1 + permutation[jj + j1 + permutation[kk + k1]]], x1, y1, z1)
+             + corner(permutation[ii + i2 + permutation[jj + j2 + permutation[kk + k2]]], x2, y2, z2)
+             + corner(permutation[ii + 1 + permutation[jj + 1 + permutation[kk + 1]]], x3, y3, z3);
+
+    // Scale to [-1, 1]
+    return 76.0 * n;
+}
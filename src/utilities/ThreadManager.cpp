@@ -1,10 +1,29 @@
 #include "utilities/ThreadManager.h"
+#include "utilities/ScratchArena.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+
+// The pool and index of the worker running on this thread, if any
+static thread_local ThreadManager* currentPool = nullptr;
+static thread_local size_t currentWorker = 0;
+
+// Tasks added by this thread, to pick the ones whose wait is timed
+static thread_local unsigned int tasksAdded = 0;
+
+static long long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ThreadManager::ThreadManager(size_t numThreads) 
+    : peakPendingTasks(0), statsStart(nowNs()), nextQueue(0), sleepingWorkers(0), waking(false), stop(false) {
+    for (size_t i = 0; i < numThreads; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
 
-ThreadManager::ThreadManager(size_t numThreads) : stop(false) {
     // Create worker threads
     for (size_t i = 0; i < numThreads; ++i) {
-        threads.emplace_back(&ThreadManager::workerThread, this);
+        threads.emplace_back(&ThreadManager::workerThread, this, i);
     }
 }
 
@@ -12,19 +31,187 @@ ThreadManager::~ThreadManager() {
     shutdown();
 }
 
-void ThreadManager::addTask(const std::function<void()>& task) {
+void ThreadManager::addTask(Task task, TaskCategory category, std::atomic<int>* group) {
+    if (queues.empty()) return;
+
+    // Tasks that are not timed keep a zero timestamp
+    bool timed = tasksAdded++ % timedTaskInterval == 0;
+    QueuedTask queued = { std::move(task), category, timed ? nowNs() : 0, group };
+
+    // Tasks spawned by a task stay on its worker, where their data is likely still in cache
+    if (currentPool == this) {
+        WorkerQueue& queue = *queues[currentWorker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.pushBack(std::move(queued));
+        queue.size.store(queue.tasks.size());
+    } else if (overflowSize.load(std::memory_order_relaxed) > 0 || !submitted.tryPush(std::move(queued))) {
+        // Once tasks overflow, later ones queue behind them until the workers caught up.
+        // Behind a backlog, the worker that takes the task in front finds this one, so 
+        // only the first task needs its size ordered before the check for sleeping workers
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        bool backlog = !overflow.empty();
+        overflow.push_back(std::move(queued));
+        overflowSize.store(overflow.size(), backlog ? std::memory_order_relaxed : std::memory_order_seq_cst);
+    }
+    if (timed) {
+        int depth = (int)pendingTasks();
+        int peak = peakPendingTasks.load(std::memory_order_relaxed);
+        while (depth > peak && !peakPendingTasks.compare_exchange_weak(peak, depth, std::memory_order_relaxed)) {}
+    }
+
+    // A worker going to sleep counts itself before checking for tasks, and the push above 
+    // comes before this check, so either it sees the task or it is seen here and woken
+    wakeWorker();
+}
+
+size_t ThreadManager::pendingTasks() const {
+    size_t pending = submitted.size() + overflowSize.load();
+    for (const auto& queue : queues) {
+        pending += queue->size.load();
+    }
+    return pending;
+}
+
+void ThreadManager::wakeWorker() {
+    // While a worker is being woken it is still counted as sleeping, and once awake it 
+    // clears the flag before checking for tasks, so skipping the notify here loses no task
+    if (sleepingWorkers.load() == 0 || waking.load()) return;
+
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    if (sleepingWorkers.load() > 0 && !waking.load()) {
+        waking.store(true);
+        condition.notify_one();
+    }
+}
+
+bool ThreadManager::runPendingTask() {
+    if (queues.empty()) return false;
+
+    // Workers start with their own queue, other threads anywhere
+    size_t index = currentPool == this ? currentWorker : nextQueue++ % queues.size();
+    QueuedTask task;
+    if (!takeTask(index, task)) return false;
+    runTask(task, currentPool == this ? queues[currentWorker]->counters : helperCounters);
+    return true;
+}
+
+long long ThreadManager::runTask(QueuedTask& task, TaskCounters& counters) {
+    bool timed = task.queuedAt != 0;
+    long long start = timed ? nowNs() : 0;
     {
-        // Lock the task queue
-        std::unique_lock<std::mutex> lock(queueMutex);
-        taskQueue.push(task);
+        // Scratch the task left behind is freed, also when it ran inside another task's wait
+        ScratchScope scratch;
+        task.task();
+    }
+    long long end = timed ? nowNs() : 0;
+
+    // Several threads can share the helper counters, so these are read-modify-writes
+    counters.tasks[task.category].fetch_add(1, std::memory_order_relaxed);
+    if (timed) {
+        long long wait = start - task.queuedAt;
+        counters.samples[task.category].fetch_add(1, std::memory_order_relaxed);
+        counters.waitNs[task.category].fetch_add(wait, std::memory_order_relaxed);
+        counters.runNs[task.category].fetch_add(end - start, std::memory_order_relaxed);
+        long long maxWait = counters.maxWaitNs[task.category].load(std::memory_order_relaxed);
+        while (wait > maxWait && !counters.maxWaitNs[task.category].compare_exchange_weak(maxWait, wait, std::memory_order_relaxed)) {}
+    }
+
+    // Only now, so a group that finished waiting sees its tasks in the statistics
+    if (task.group) {
+        (*task.group)--;
+    }
+    return end;
+}
+
+ThreadPoolStats ThreadManager::getStats() const {
+    ThreadPoolStats stats;
+    stats.seconds = (nowNs() - statsStart.load(std::memory_order_relaxed)) / 1e9;
+    stats.queueDepth = (int)pendingTasks();
+    stats.peakQueueDepth = peakPendingTasks.load(std::memory_order_relaxed);
+
+    long long samples[TASK_CATEGORY_COUNT] = {};
+    long long waitNs[TASK_CATEGORY_COUNT] = {};
+    long long runNs[TASK_CATEGORY_COUNT] = {};
+    auto add = [&](const TaskCounters& counters) {
+        for (int i = 0; i < TASK_CATEGORY_COUNT; i++) {
+            ThreadPoolStats::Category& category = stats.categories[i];
+            category.tasks += counters.tasks[i].load(std::memory_order_relaxed);
+            samples[i] += counters.samples[i].load(std::memory_order_relaxed);
+            waitNs[i] += counters.waitNs[i].load(std::memory_order_relaxed);
+            runNs[i] += counters.runNs[i].load(std::memory_order_relaxed);
+            category.maxWaitMs = std::max(category.maxWaitMs, counters.maxWaitNs[i].load(std::memory_order_relaxed) / 1e6);
+        }
+    };
+
+    for (const auto& queue : queues) {
+        add(queue->counters);
+        double busy = stats.seconds > 0.0 ? queue->counters.busyNs.load(std::memory_order_relaxed) / 1e9 / stats.seconds : 0.0;
+        stats.workerBusy.push_back(std::min(busy, 1.0));
+    }
+    add(helperCounters);
+
+    for (int i = 0; i < TASK_CATEGORY_COUNT; i++) {
+        ThreadPoolStats::Category& category = stats.categories[i];
+        if (samples[i] > 0) {
+            category.averageWaitMs = waitNs[i] / 1e6 / samples[i];
+            category.averageRunMs = runNs[i] / 1e6 / samples[i];
+        }
+    }
+    return stats;
+}
+
+void ThreadManager::resetStats() {
+    auto clear = [](TaskCounters& counters) {
+        for (int i = 0; i < TASK_CATEGORY_COUNT; i++) {
+            counters.tasks[i].store(0, std::memory_order_relaxed);
+            counters.samples[i].store(0, std::memory_order_relaxed);
+            counters.waitNs[i].store(0, std::memory_order_relaxed);
+            counters.maxWaitNs[i].store(0, std::memory_order_relaxed);
+            counters.runNs[i].store(0, std::memory_order_relaxed);
+        }
+        counters.busyNs.store(0, std::memory_order_relaxed);
+    };
+    for (auto& queue : queues) {
+        clear(queue->counters);
+    }
+    clear(helperCounters);
+    peakPendingTasks.store((int)pendingTasks(), std::memory_order_relaxed);
+    statsStart.store(nowNs(), std::memory_order_relaxed);
+}
+
+void ThreadManager::parallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body) {
+    grainSize = std::max(grainSize, 1);
+    TaskGroup group(*this);
+    for (int rangeBegin = begin; rangeBegin < end; rangeBegin += grainSize) {
+        int rangeEnd = std::min(rangeBegin + grainSize, end);
+        group.run([&body, rangeBegin, rangeEnd]() { body(rangeBegin, rangeEnd); });
+    }
+    group.wait();
+}
+
+void ThreadManager::runBatch(std::vector<Task>& tasks) {
+    TaskGroup group(*this);
+    for (Task& task : tasks) {
+        group.run([&task]() { task(); });
+    }
+    group.wait();
+}
+
+void TaskGroup::wait() {
+    // Help with queued work instead of blocking, the group's own tasks may be among it
+    while (pending.load() > 0) {
+        if (!threadManager.runPendingTask()) {
+            std::this_thread::yield();
+        }
     }
-    // Notify one thread that a task is available
-    condition.notify_one();
 }
 
 void ThreadManager::shutdown() {
     // Set the stop flag
-    stop.store(true);
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stop.store(true);
+    }
     // Notify all threads to wake up
     condition.notify_all();
 
@@ -36,28 +223,99 @@ void ThreadManager::shutdown() {
     }
 }
 
-void ThreadManager::workerThread() {
-    while (true) {
-        std::function<void()> task;
+bool ThreadManager::takeTask(size_t workerIndex, QueuedTask& task) {
+    WorkerQueue& own = *queues[workerIndex];
+    if (own.size.load(std::memory_order_relaxed) > 0) {
+        // Own queue first, newest task
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.popBack();
+            own.size.store(own.tasks.size(), std::memory_order_relaxed);
+            return true;
+        }
+    }
 
-        {
-            // Lock the queue to retrieve a task
-            std::unique_lock<std::mutex> lock(queueMutex);
+    if (submitted.tryPop(task)) {
+        return true;
+    }
+    if (overflowSize.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(overflowMutex);
+        if (!overflow.empty()) {
+            task = std::move(overflow.front());
+            overflow.pop_front();
+            overflowSize.store(overflow.size(), std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Steal the oldest task of the other workers, starting with the next one
+    for (size_t i = 1; i < queues.size(); i++) {
+        WorkerQueue& victim = *queues[(workerIndex + i) % queues.size()];
+        if (victim.size.load(std::memory_order_relaxed) == 0) continue;
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.popFront();
+            victim.size.store(victim.tasks.size(), std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadManager::workerThread(size_t workerIndex) {
+    currentPool = this;
+    currentWorker = workerIndex;
 
-            // Wait until there is a task or the thread manager is stopping
-            condition.wait(lock, [this]() { return !taskQueue.empty() || stop.load(); });
+    // Busy time is added up to each timed task and up to going to sleep, so
+    // untimed tasks do not read the clock
+    TaskCounters& counters = queues[workerIndex]->counters;
+    long long busySince = nowNs();
+    while (true) {
+        QueuedTask task;
 
-            // Exit if stopping and no more tasks are left
-            if (stop.load() && taskQueue.empty()) {
-                return;
+        if (takeTask(workerIndex, task)) {
+            // Execute the task
+            long long end = runTask(task, counters);
+            if (end != 0) {
+                counters.busyNs.fetch_add(end - busySince, std::memory_order_relaxed);
+                busySince = end;
             }
+            continue;
+        }
+        counters.busyNs.fetch_add(nowNs() - busySince, std::memory_order_relaxed);
 
-            // Get the next task
-            task = taskQueue.front();
-            taskQueue.pop();
+        // Wait until there is a task or the thread manager is stopping. A wakeup clears the
+        // flag before the tasks are checked again, so a task added while the flag was set is seen.
+        // This is a condition variable rather than a futex or atomic wait: C++17 has no atomic
+        // wait, a raw futex would tie the pool to Linux, and adding a task only reaches this lock
+        // when a worker is asleep, so a futex would not make the usual add any cheaper
+        bool slept = false;
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepingWorkers++;
+            while (pendingTasks() == 0 && !stop.load()) {
+                condition.wait(lock);
+                waking.store(false);
+                slept = true;
+            }
+            sleepingWorkers--;
         }
+        busySince = nowNs();
 
-        // Execute the task
-        task();
+        // Counted but not found, another thread is still writing the task into its slot.
+        // Let it finish instead of spinning, it may be waiting for this core
+        if (!slept && !stop.load()) {
+            std::this_thread::yield();
+        }
+
+        // Pass the wakeup on while there is more work than this worker takes
+        if (pendingTasks() > 1) {
+            wakeWorker();
+        }
+
+        // Exit if stopping and no more tasks are left
+        if (stop.load() && pendingTasks() == 0) {
+            return;
+        }
     }
 }
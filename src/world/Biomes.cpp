@@ -0,0 +1,137 @@
+#include "world/Biomes.h"
+#include "world/Materials.h"
+
+const double unbounded = 1e9;
+
+const std::vector<BiomeDefinition>& defaultBiomes() {
+    static const std::vector<BiomeDefinition> biomes = {
+        // type        height                 humidity               temperature            layers                           base      fill      blend
+        { OCEAN,       -unbounded, 0.45,      -unbounded, unbounded, -unbounded, unbounded, { { ID_SAND, 2 } },                  ID_STONE, ID_WATER },
+        { MOUNTAINS,   0.6, unbounded,        -unbounded, unbounded, -unbounded, unbounded, {},                                  ID_STONE, ID_AIR,   0.02f },
+        { RAINFOREST,  0.45, 0.6,             0.5, unbounded,        0.66, unbounded,       { { ID_GRASS, 1 }, { ID_DIRT, 3 } }, ID_STONE, ID_AIR },
+        { FOREST,      0.45, 0.6,             0.5, unbounded,        0.33, 0.66,            { { ID_GRASS, 1 }, { ID_DIRT, 3 } }, ID_STONE, ID_AIR },
+        { TAIGA,       0.45, 0.6,             0.5, unbounded,        -unbounded, 0.33,      { { ID_GRASS, 1 }, { ID_DIRT, 3 } }, ID_STONE, ID_AIR },
+        { DESSERT,     0.45, 0.6,             -unbounded, 0.5,       0.66, unbounded,       { { ID_SAND, 9 } },                  ID_STONE, ID_AIR },
+        { PLAINS,      0.45, 0.6,             -unbounded, 0.5,       0.33, 0.66,            { { ID_GRASS, 1 }, { ID_DIRT, 3 } }, ID_STONE, ID_AIR },
+        { SNOW,        0.45, 0.6,             -unbounded, 0.5,       -unbounded, 0.33,      { { ID_GRASS, 1 }, { ID_DIRT, 3 } }, ID_STONE, ID_AIR },
+    };
+    return biomes;
+}
+
+// Adds the finite edges of a range to an axis
+static void addEdges(std::vector<double>& edges, double min, double max) {
+    if (min > -unbounded) edges.push_back(min);
+    if (max < unbounded) edges.push_back(max);
+}
+
+static void sortEdges(std::vector<double>& edges) {
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+}
+
+// A value inside the cell, used to classify the whole cell
+static double cellSample(const std::vector<double>& edges, int cell) {
+    if (edges.empty()) return 0.0;
+    if (cell == 0) return edges.front() - 1.0;
+    if (cell == (int)edges.size()) return edges.back() + 1.0;
+    return 0.5f * (edges[cell - 1] + edges[cell]);
+}
+
+static bool inRange(double value, double min, double max) {
+    return value > min && value <= max;
+}
+
+BiomeTable::BiomeTable(const std::vector<BiomeDefinition>& definitions)
+    : definitions(definitions) {
+    for (const BiomeDefinition& def : definitions) {
+        addEdges(heightEdges, def.minHeight, def.maxHeight);
+        addEdges(humidEdges, def.minHumid, def.maxHumid);
+        addEdges(tempEdges, def.minTemp, def.maxTemp);
+    }
+    sortEdges(heightEdges);
+    sortEdges(humidEdges);
+    sortEdges(tempEdges);
+
+    // Bake the biome of every climate cell
+    int heightCells = heightEdges.size() + 1;
+    int humidCells = humidEdges.size() + 1;
+    int tempCells = tempEdges.size() + 1;
+    climateTable.resize(heightCells * humidCells * tempCells, definitions.front().type);
+    for (int t = 0; t < tempCells; t++) {
+        for (int hu = 0; hu < humidCells; hu++) {
+            for (int h = 0; h < heightCells; h++) {
+                double height = cellSample(heightEdges, h);
+                double humid = cellSample(humidEdges, hu);
+                double temp = cellSample(tempEdges, t);
+                for (const BiomeDefinition& def : definitions) {
+                    if (inRange(height, def.minHeight, def.maxHeight) &&
+                        inRange(humid, def.minHumid, def.maxHumid) &&
+                        inRange(temp, def.minTemp, def.maxTemp)) {
+                        climateTable[h + hu * heightCells + t * heightCells * humidCells] = def.type;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Bake the layers of every biome
+    for (const BiomeDefinition& def : definitions) {
+        int depth = 0;
+        for (const BiomeLayer& layer : def.layers) {
+            for (int i = 0; i < layer.depth && depth < maxLayerDepth; i++, depth++) {
+                layerTable[def.type][depth] = layer.materialID;
+            }
+        }
+        surfaceDepth = std::max(surfaceDepth, depth - 1);
+        for (; depth <= maxLayerDepth; depth++) {
+            layerTable[def.type][depth] = def.baseMaterial;
+        }
+        fillTable[def.type] = def.fillMaterial;
+    }
+}
+
+int BiomeTable::cellIndex(const std::vector<double>& edges, float value) {
+    int cell = 0;
+    for (double edge : edges) {
+        cell += value > edge;
+    }
+    return cell;
+}
+
+BiomeType BiomeTable::lookup(float height, float humid, float temp) const {
+    int heightCells = heightEdges.size() + 1;
+    int humidCells = humidEdges.size() + 1;
+    int idx = cellIndex(heightEdges, height) 
+            + cellIndex(humidEdges, humid) * heightCells 
+            + cellIndex(tempEdges, temp) * heightCells * humidCells;
+    return (BiomeType)climateTable[idx];
+}
+
+void BiomeTable::lookupBlend(float height, float humid, float temp, BiomeType& biome, BiomeType& blendBiome, float& blendChance) const {
+    biome = lookup(height, humid, temp);
+    blendBiome = biome;
+    blendChance = 0.0f;
+
+    for (const BiomeDefinition& def : definitions) {
+        float width = def.blendWidth;
+        if (width <= 0.0f) continue;
+
+        // Position across the blending edge, 0.5 on the edge itself
+        float factor = 0.5f * (height + width - (float)def.minHeight) / width;
+        if (factor < 0.0f || factor > 1.0f) continue;
+
+        if (biome == def.type && factor >= 0.5f) {
+            // Inside the biome, mixed with the biome below the edge
+            blendBiome = lookup(height - width, humid, temp);
+            blendChance = 1.0f - factor;
+            return;
+        } 
+        if (biome != def.type && factor < 0.5f && lookup(height + width, humid, temp) == def.type) {
+            // Below the edge, mixed with the biome above it
+            blendBiome = def.type;
+            blendChance = factor;
+            return;
+        }
+    }
+}
@@ -37,6 +37,11 @@ void Chunk::forEachVoxel(std::function<void(const Vec3&, Voxel&)> callback) {
     }
 }
 
+void Chunk::fill(const Voxel& voxel) {
+    std::fill(voxels, voxels + numVoxels, voxel);
+    isEmpty = !voxel.isSolid();
+}
+
 // voxel manipulation with bounds and dirty flag handling
 bool Chunk::addVoxel(const Vec3& localPosition, const Voxel& newVoxel) {
     Voxel* voxel = getVoxel(localPosition);
@@ -60,6 +65,21 @@ Voxel* Chunk::getVoxel(const Vec3& localPosition) {
     return &voxels[positionToIndex(localPosition)];
 }
 
+Voxel* Chunk::getVoxelNear(const Vec3& localPosition) {
+    int x = (int)std::floor(localPosition.x), y = (int)std::floor(localPosition.y), z = (int)std::floor(localPosition.z);
+    int dx = x < 0 ? -1 : (x >= size ? 1 : 0);
+    int dy = y < 0 ? -1 : (y >= size ? 1 : 0);
+    int dz = z < 0 ? -1 : (z >= size ? 1 : 0);
+    x -= dx * size;
+    y -= dy * size;
+    z -= dz * size;
+    if (x < 0 || x >= size || y < 0 || y >= size || z < 0 || z >= size) return nullptr;
+
+    Chunk* chunk = neighbours[neighbourIndex(dx, dy, dz)];
+    if (!chunk) return nullptr;
+    return &chunk->voxels[x + y * size + z * size * size];
+}
+
 // bounds checking
 bool Chunk::positionInBounds(const Vec3& localPosition) const {
     return localPosition.x >= 0 && localPosition.x < size &&
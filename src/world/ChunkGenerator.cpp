@@ -1,102 +1,127 @@
 #include "world/ChunkGenerator.h"
 #include "world/WorldManager.h"
+#include "utilities/ScratchArena.h"
+#include "utilities/SeedSequence.h"
+#include <climits>
 
-void ChunkGenerator::generateChunkColumn(ChunkColumn* column) {
-    for (int x = 0; x < chunkSize; x++) {
-        for (int z = 0; z < chunkSize; z++) {
-            Vec2 wp2D = column->worldPosition2D + Vec2(x, z);
-            // Generate height
-            float height = generateHeight(wp2D);
-            int worldHeight = height * 255;
+std::chrono::steady_clock::time_point GenerationStats::record(ChunkStage stage, std::chrono::steady_clock::time_point start, int calls) {
+    auto now = std::chrono::steady_clock::now();
+    nanoseconds[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+    count[stage] += calls;
+    return now;
+}
 
-            // Generate humidity
-            float humid = 0.5 + 0.5 * perlin.octaveNoise(wp2D.x, wp2D.z, 3, 0.5, 0.002, Vec2(1000, 1000));
+double GenerationStats::averageMs(ChunkStage stage) const {
+    int calls = count[stage].load();
+    return calls == 0 ? 0.0 : nanoseconds[stage].load() / 1e6 / calls;
+}
 
-            // Generate temperature
-            float temp = 0.5 + 0.5 * perlin.octaveNoise(wp2D.x, wp2D.z, 3, 0.5, 0.0015, Vec2(-1000, -1000));
-            BiomeType biome = getBiome(height, humid, temp);
-            
-            ColumnData data;
-            data.biome = biome;
-            data.worldHeight = worldHeight;
-            data.height = height;
-            data.humidity = humid;
-            data.temperature = temp;
-
-            column->setData(Vec2(x, z), data);
-        }
+void GenerationStats::reset() {
+    for (int i = 0; i <= STAGE_UPLOAD_READY; i++) {
+        nanoseconds[i] = 0;
+        count[i] = 0;
     }
 }
 
-BiomeType ChunkGenerator::getBiome(float height, float humid, float temp) {
-    BiomeType biome;
-    if (height < 0.45) {
-        biome = OCEAN;
-    } else if (height > 0.6) {
-        biome = MOUNTAINS;
-    } else {
-        if (humid > 0.5) {
-            if (temp > 0.66) {
-                biome = RAINFOREST;
-            } else if (temp > 0.33) {
-                biome = FOREST;
-            } else {
-                biome = TAIGA;
-            }
-        } else {
-            if (temp > 0.66) {
-                biome = DESSERT;
-            } else if (temp > 0.33) {
-                biome = PLAINS;
-            } else {
-                biome = SNOW;
-            }
-        }
-    }
+void ChunkGenerator::generateChunkColumn(ChunkColumn* column) {
+    generateColumnTile({ column });
+}
 
-    return biome;
+ChunkGenerator::CoarseClimate ChunkGenerator::sampleCoarseClimate(double x, double z) const {
+    CoarseClimate climate;
+    climate.height = noise->octaveSum(x, z, 0, heightCoarseOctaves, 0.5, 0.002);
+    climate.mountain = noise->octaveSum(x, z, 0, mountainCoarseOctaves, 0.5, 0.005, Vec2(-1000, 1000));
+    climate.humidity = noise->octaveSum(x, z, 0, 3, 0.5, 0.002, Vec2(1000, 1000));
+    climate.temperature = noise->octaveSum(x, z, 0, 3, 0.5, 0.0015, Vec2(-1000, -1000));
+    return climate;
 }
 
-Voxel ChunkGenerator::generateVoxel(const Vec3& worldPosition, BiomeType biome, int worldHeight) {
-    std::uniform_real_distribution uniformDist(0.0, 1.0);
-    int y = worldPosition.y;
-    Voxel newVoxel = 0;
-    if (y > worldHeight) return newVoxel;
-
-    switch (biome) {
-    case MOUNTAINS:
-        newVoxel.setMatID(ID_STONE);
-        break;
-    case DESSERT:
-        if (y >= worldHeight - 8) {
-            newVoxel.setMatID(ID_SAND);
-        } else {
-            newVoxel.setMatID(ID_STONE);
+void ChunkGenerator::generateColumnTile(const std::vector<ChunkColumn*>& columns) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Coarse grid covering every column of the tile, columns start on grid points
+    int minX = INT_MAX, minZ = INT_MAX, maxX = INT_MIN, maxZ = INT_MIN;
+    for (ChunkColumn* column : columns) {
+        minX = std::min(minX, (int)column->worldPosition2D.x);
+        minZ = std::min(minZ, (int)column->worldPosition2D.z);
+        maxX = std::max(maxX, (int)column->worldPosition2D.x + chunkSize);
+        maxZ = std::max(maxZ, (int)column->worldPosition2D.z + chunkSize);
+    }
+    int gridX = (maxX - minX) / tileGridStep + 1;
+    int gridZ = (maxZ - minZ) / tileGridStep + 1;
+
+    ScratchScope scratch;
+    std::pmr::vector<CoarseClimate> grid(gridX * gridZ, &scratch.getArena());
+    for (int k = 0; k < gridZ; k++) {
+        for (int i = 0; i < gridX; i++) {
+            grid[i + k * gridX] = sampleCoarseClimate(minX + i * tileGridStep, minZ + k * tileGridStep);
         }
-        break;
-    default:
-        if (y == worldHeight) {
-            newVoxel.setMatID(ID_GRASS);
-        } else if (y >= worldHeight -3) {
-            newVoxel.setMatID(ID_DIRT);
-        } else {
-            newVoxel.setMatID(ID_STONE);
-        }  
-        break;
     }
 
-    return newVoxel;
+    const double humidNorm = Noise::octaveNormalization(3, 0.5);
+    const double tempNorm = Noise::octaveNormalization(3, 0.5);
+    const float invStep = 1.0f / tileGridStep;
+
+    for (ChunkColumn* column : columns) {
+        column->minHeight = INT_MAX;
+        column->maxHeight = INT_MIN;
+        for (int x = 0; x < chunkSize; x++) {
+            for (int z = 0; z < chunkSize; z++) {
+                Vec2 wp2D = column->worldPosition2D + Vec2(x, z);
+
+                // Bilinear interpolation of the coarse grid
+                int gx = ((int)wp2D.x - minX) / tileGridStep, gz = ((int)wp2D.z - minZ) / tileGridStep;
+                double tx = ((int)wp2D.x - minX - gx * tileGridStep) * invStep;
+                double tz = ((int)wp2D.z - minZ - gz * tileGridStep) * invStep;
+                const CoarseClimate& c00 = grid[gx + gz * gridX];
+                const CoarseClimate& c10 = grid[gx + 1 + gz * gridX];
+                const CoarseClimate& c01 = grid[gx + (gz + 1) * gridX];
+                const CoarseClimate& c11 = grid[gx + 1 + (gz + 1) * gridX];
+                auto lerp2 = [tx, tz](double a, double b, double c, double d) {
+                    return mix(mix(a, b, tx), mix(c, d, tx), tz);
+                };
+                CoarseClimate coarse;
+                coarse.height = lerp2(c00.height, c10.height, c01.height, c11.height);
+                coarse.mountain = lerp2(c00.mountain, c10.mountain, c01.mountain, c11.mountain);
+                coarse.humidity = lerp2(c00.humidity, c10.humidity, c01.humidity, c11.humidity);
+                coarse.temperature = lerp2(c00.temperature, c10.temperature, c01.temperature, c11.temperature);
+
+                // Generate height
+                float height = generateHeight(wp2D, coarse);
+                int worldHeight = height * 255;
+
+                // Humidity and temperature only have low octaves
+                float humid = 0.5 + 0.5 * coarse.humidity / humidNorm;
+                float temp = 0.5 + 0.5 * coarse.temperature / tempNorm;
+
+                ColumnData data;
+                biomeTable.lookupBlend(height, humid, temp, data.biome, data.blendBiome, data.blendChance);
+                data.worldHeight = worldHeight;
+                data.height = height;
+                data.humidity = humid;
+                data.temperature = temp;
+
+                column->setData(Vec2(x, z), data);
+                column->minHeight = std::min(column->minHeight, worldHeight);
+                column->maxHeight = std::max(column->maxHeight, worldHeight);
+            }
+        }
+    }
+    stats.record(STAGE_COLUMN, start, columns.size());
 }
 
-float ChunkGenerator::generateHeight(const Vec2& worldPosition2D) {
+float ChunkGenerator::generateHeight(const Vec2& worldPosition2D, const CoarseClimate& coarse) const {
     int x = worldPosition2D.x, z = worldPosition2D.z;
 
-    float height = 0.5 + 0.2 * perlin.octaveNoise(x, z, 5, 0.5, 0.002);
+    // The high octaves are sampled per position on top of the interpolated low ones
+    double heightSum = coarse.height + noise->octaveSum(x, z, heightCoarseOctaves, 5, 0.5, 0.002);
+    float height = 0.5 + 0.2 * heightSum / Noise::octaveNormalization(5, 0.5);
     
     float mountainThreshold = 0.02f;
     float mountainBlending = 0.5 * (height + mountainThreshold - 0.6) / mountainThreshold;
     if (mountainBlending >= 0.0) {
-        float mountainHeight = 0.5 * perlin.octaveNoise(x, z, 4, 0.5, 0.005, Vec2(-1000, 1000));
+        double mountainSum = coarse.mountain + noise->octaveSum(x, z, mountainCoarseOctaves, 4, 0.5, 0.005, Vec2(-1000, 1000));
+        float mountainHeight = 0.5 * mountainSum / Noise::octaveNormalization(4, 0.5);
         mountainHeight = height + height * mountainHeight;
         height = mix(height, mountainHeight, mountainBlending);
     }
@@ -104,120 +129,221 @@ float ChunkGenerator::generateHeight(const Vec2& worldPosition2D) {
     return height;
 }
 
-void ChunkGenerator::generateTree(const Vec3& worldPosition) {
-    const Vec3 trunk[6] = { Vec3(0, 5, 0), Vec3(0, 4, 0), Vec3(0, 3, 0), Vec3(0, 2, 0), Vec3(0, 1, 0), Vec3(0, 0, 0) };
-    const Vec3 crown[17] {
-        Vec3(0, 6, 0),
-        Vec3(1, 5, 0), Vec3(-1, 5, 0), Vec3(0, 5, 1), Vec3(0, 5, -1),
-        Vec3(1, 4, 0), Vec3(-1, 4, 0), Vec3(0, 4, 1), Vec3(0, 4, -1),
-        Vec3(1, 3, 0), Vec3(-1, 3, 0), Vec3(0, 3, 1), Vec3(0, 3, -1),
-        Vec3(1, 2, 0), Vec3(-1, 2, 0), Vec3(0, 2, 1), Vec3(0, 2, -1),
-    };
+std::mt19937 ChunkGenerator::chunkRandom(const Vec3& chunkWorldPosition, unsigned int salt) const {
+    SeedSequence<5> seq = { { seed, salt, (unsigned int)(int)chunkWorldPosition.x, 
+                              (unsigned int)(int)chunkWorldPosition.y, (unsigned int)(int)chunkWorldPosition.z } };
+    return std::mt19937(seq);
+}
 
-    Voxel wood = ID_WOOD;
-    for (const Vec3& pos : trunk) {
-        worldManager.addVoxel(worldPosition + pos, wood);
+void ChunkGenerator::stampPrefab(Chunk* chunk, const Prefab& prefab, const Vec3& worldPosition) {
+    // Chunks the prefab's bounds overlap
+    Vec3 blockMin = worldPosition - prefab.anchor;
+    Vec3 minChunk = floor(blockMin / chunkSize);
+    Vec3 maxChunk = floor((blockMin + prefab.size - Vec3(1)) / chunkSize);
+    Vec3 ownChunk = floor(chunk->worldPosition / chunkSize);
+    int dx = maxChunk.x - minChunk.x + 1, dy = maxChunk.y - minChunk.y + 1, dz = maxChunk.z - minChunk.z + 1;
+
+    // Split the cells by target chunk, writing the chunk's own portion directly
+    ScratchScope scratch;
+    std::pmr::vector<std::pmr::vector<PendingWrite>> targets(dx * dy * dz, &scratch.getArena());
+    for (const PrefabCell& cell : prefab.cells) {
+        Vec3 wp = worldPosition + Vec3(cell.x, cell.y, cell.z);
+        Vec3 chunkPos = floor(wp / chunkSize);
+        Vec3 localPos = wp - chunkPos * chunkSize;
+        const Voxel& voxel = prefab.palette[cell.paletteIndex];
+        if (chunkPos == ownChunk) {
+            if (chunk->addVoxel(localPos, voxel)) chunk->isEmpty = false;
+        } else {
+            Vec3 t = chunkPos - minChunk;
+            targets[t.x + t.y * dx + t.z * dx * dy].push_back({ localPos, voxel });
+        }
     }
 
-    Voxel leaves = ID_LEAVES;
-    for (const Vec3& pos : crown) {
-        worldManager.addVoxel(worldPosition + pos, leaves);
-    }   
+    for (int i = 0; i < (int)targets.size(); i++) {
+        if (targets[i].empty()) continue;
+        Vec3 chunkPos = minChunk + Vec3(i % dx, (i / dx) % dy, i / (dx * dy));
+        worldManager.deferVoxels(chunkPos, targets[i].data(), targets[i].size());
+    }
 }
 
-void ChunkGenerator::generateFeatures(Chunk* chunk) {
-    std::uniform_int_distribution uniformDist(1, 30);
-    Vec2 columnPos = floor(chunk->worldPosition.xz() / chunkSize);
-    ChunkColumn* column = worldManager.getColumn(columnPos);
+void ChunkGenerator::generateFeatures(Chunk* chunk, ChunkColumn* column) {
+    std::mt19937 rng = chunkRandom(chunk->worldPosition, 1);
     for (int x = 0; x < chunkSize; x++) {
         for (int z = 0; z < chunkSize; z++) {
-            int height = column->getData(Vec2(x, z)).worldHeight;
-            if (height >= chunk->worldPosition.y && height < chunk->worldPosition.y + chunkSize) {
-                Vec3 wp = Vec3(chunk->worldPosition.x + x, height, chunk->worldPosition.z + z);
-                Voxel* voxel = worldManager.getVoxel(wp);
-                if (voxel && voxel->getMatID() == ID_GRASS) {
-                    if (uniformDist(rng) == 1) generateTree(wp + Vec3(0, 1, 0));
-                }
-            }            
+            ColumnData data = column->getData(Vec2(x, z));
+            int height = data.worldHeight;
+            if (height < chunk->worldPosition.y || height >= chunk->worldPosition.y + chunkSize) continue;
+
+            Vec3 localPos = Vec3(x, height - chunk->worldPosition.y, z);
+            uint8_t surface = chunk->getVoxel(localPos)->getMatID();
+            for (const FeatureRule& rule : prefabs.rules[data.biome]) {
+                if (surface != rule.surfaceMaterial || rng() % rule.chance != 0) continue;
+                const Prefab& prefab = prefabs.prefabs[rule.variants[rng() % rule.variants.size()]];
+                stampPrefab(chunk, prefab, chunk->worldPosition + localPos + Vec3(0, 1, 0));
+                break;
+            }
         }
     }
-    chunk->state = DONE;
 }
 
-void ChunkGenerator::generateChunk(Chunk* chunk) {
+void ChunkGenerator::generateChunk(Chunk* chunk, ChunkColumn* column) {
+    if (generateChunkTerrain(chunk, column)) {
+        generateChunkFeatures(chunk, column);
+    }
+}
+
+bool ChunkGenerator::generateChunkTerrain(Chunk* chunk, ChunkColumn* column) {
+    if (chunk->cancelled) return false;
+    auto start = std::chrono::steady_clock::now();
+
+    // Chunks entirely above the surface or below the deepest surface layer skip the per voxel terrain
+    int bottom = chunk->worldPosition.y, top = bottom + chunkSize - 1;
+    bool aboveSurface = bottom > std::max(column->maxHeight, waterHeight);
+    bool belowSurface = top < column->minHeight - biomeTable.getSurfaceDepth();
+
+    if (belowSurface) {
+        chunk->fill(ID_STONE);
+    } else if (!aboveSurface) {
+        generateTerrain(chunk, column);
+    }
+    generateSky(chunk);
+    chunk->stage = STAGE_TERRAIN;
+    start = stats.record(STAGE_TERRAIN, start);
+    if (chunk->cancelled) return false;
+
+    if (!aboveSurface) generateChunk3D(chunk);   
+    chunk->stage = STAGE_CAVES;
+    stats.record(STAGE_CAVES, start);
+    return !chunk->cancelled;
+}
+
+void ChunkGenerator::generateChunkFeatures(Chunk* chunk, ChunkColumn* column) {
+    if (chunk->cancelled) return;
+    auto start = std::chrono::steady_clock::now();
+
+    // Features write into neighbours, so they run entirely or not at all
+    int bottom = chunk->worldPosition.y, top = bottom + chunkSize - 1;
+    bool aboveSurface = bottom > std::max(column->maxHeight, waterHeight);
+    bool belowSurface = top < column->minHeight - biomeTable.getSurfaceDepth();
+    if (!aboveSurface && !belowSurface) generateFeatures(chunk, column);
+    chunk->stage = STAGE_FEATURES;
+    stats.record(STAGE_FEATURES, start);
+}
+
+void ChunkGenerator::generateTerrain(Chunk* chunk, ChunkColumn* column) {
+    std::mt19937 rng = chunkRandom(chunk->worldPosition, 0);
     std::uniform_real_distribution uniformDist(0.0, 1.0);
-    Vec2 columnPos = floor(chunk->worldPosition.xz() / chunkSize);
-    ChunkColumn* column = worldManager.getColumn(columnPos);
     for (int x = 0; x < chunkSize; x++) {
         for (int z = 0; z < chunkSize; z++) {
-            int wpx = chunk->worldPosition.x + x, wpz = chunk->worldPosition.z + z;
-            
             ColumnData data = column->getData(Vec2(x, z));
-            BiomeType biome = data.biome;
-            int worldHeight = data.worldHeight;
-            float height = data.height;
-            float humid = data.humidity;
-            float temp = data.temperature;
-
-            float blendingThreshold = 0.02;
-            float mountainBlendFactor = 0.5 * (height + blendingThreshold - 0.6) / blendingThreshold;
-            float humidBlendFactor = 0.5 * (humid + blendingThreshold - 0.5) / blendingThreshold;
-            float warmBlendFactor = 0.5 * (temp + blendingThreshold - 0.66) / blendingThreshold;
-            float coldBlendFactor = 0.5 * (temp + blendingThreshold - 0.33) / blendingThreshold;
+            int top = std::max(data.worldHeight, waterHeight);
             
             for (int y = 0; y < chunkSize; y++) {     
                 int wpy = chunk->worldPosition.y + y;
-                Voxel newVoxel = 0;
-                if (wpy > std::max(worldHeight, waterHeight)) break;
+                if (wpy > top) break;
                 chunk->isEmpty = false;
                 
-                if (biome == OCEAN) {
-                    if (wpy > worldHeight) {
-                        newVoxel.setMatID(ID_WATER);
-                    } else if (wpy >= worldHeight - 1) {
-                        newVoxel.setMatID(ID_SAND);
-                    } else {
-                        newVoxel.setMatID(ID_STONE);
-                    }
-                } else {
-                    Vec3 wp = Vec3(wpx, wpy, wpz);
-                    newVoxel = generateVoxel(wp, biome, worldHeight);
-                    
-                    if (mountainBlendFactor >= 0.5 && mountainBlendFactor <= 1.0) {
-                        BiomeType blendBiome = getBiome(height - blendingThreshold, humid, temp);
-                        Voxel blendVoxel = generateVoxel(wp, blendBiome, worldHeight);
-                        newVoxel = mountainBlendFactor > uniformDist(rng) ? newVoxel : blendVoxel;
-                    } else if (mountainBlendFactor >= 0 && mountainBlendFactor < 0.5) {
-                        BiomeType blendBiome = MOUNTAINS;
-                        Voxel blendVoxel = generateVoxel(wp, blendBiome, worldHeight);
-                        newVoxel = mountainBlendFactor > uniformDist(rng) ? blendVoxel : newVoxel;
-                    }
+                // Material from the biome's layer table, dithered with the blend biome near its edge
+                int depth = data.worldHeight - wpy;
+                BiomeType biome = data.biome;
+                if (data.blendChance > 0.0f && uniformDist(rng) < data.blendChance) {
+                    biome = data.blendBiome;
                 }
                 
-                chunk->addVoxel(Vec3(x, y, z), newVoxel);
+                chunk->addVoxel(Vec3(x, y, z), Voxel(biomeTable.material(biome, depth)));
             }
         }
     }
-    generateChunk3D(chunk);   
+}
 
-    chunk->state = GENERATED; 
+void ChunkGenerator::generateCaveDensity(const Vec3& chunkWorldPosition, float* density) const {
+    caveField.fill(chunkWorldPosition, chunkSize, chunkSize, chunkSize, [this](double x, double y, double z) {
+        return noise->noise(x / chunkSize, y / chunkSize, z / chunkSize);
+    }, density);
 }
 
 void ChunkGenerator::generateChunk3D(Chunk* chunk) {
-    Vec3 wp = chunk->worldPosition;
-    Voxel newVoxel;
-    for (double x = wp.x; x < wp.x + chunkSize; x++) {
-        for (double y = wp.y; y < wp.y + chunkSize; y++) {
-            for (double z = wp.z; z < wp.z + chunkSize; z++) {
-                double val = perlin.noise(x / chunkSize, y / chunkSize, z / chunkSize);
-                if (val < -0.4) {
-                    Vec3 wp = Vec3(x, y, z);
-                    auto voxel = worldManager.getVoxel(wp);
-                    if (voxel && !voxel->isTransparent()) {
-                        worldManager.removeVoxel(wp); 
-                    }
+    float density[Chunk::numVoxels];
+    generateCaveDensity(chunk->worldPosition, density);
+
+    // density is laid out like the voxel array, so carve directly by index
+    for (int i = 0; i < Chunk::numVoxels; i++) {
+        Voxel& voxel = chunk->voxels[i];
+        if (density[i] < caveThreshold && voxel.isSolid() && !voxel.isTransparent()) {
+            voxel = ID_AIR;
+        }
+    }
+}
+
+double ChunkGenerator::islandDensity(double x, double y, double z) const {
+    if (y < islandMinHeight || y > islandMaxHeight) return -1.0;
+
+    // Islands are thickest in the middle of the band and fade out towards its edges
+    double t = (y - islandMinHeight) / (islandMaxHeight - islandMinHeight);
+    double falloff = (2.0 * t - 1.0) * (2.0 * t - 1.0);
+
+    double placement = noise->noise(x * 0.004 + 500.5, z * 0.004 + 500.5);
+    double shape = noise->noise(x / 40.0, y / 20.0, z / 40.0);
+    return 0.6 * placement + 0.4 * shape - falloff;
+}
+
+double ChunkGenerator::cloudDensity(double x, double y, double z) const {
+    if (y < cloudMinHeight || y > cloudMaxHeight) return -1.0;
+
+    double t = (y - cloudMinHeight) / (cloudMaxHeight - cloudMinHeight);
+    double falloff = (2.0 * t - 1.0) * (2.0 * t - 1.0);
+
+    double cover = noise->noise(x * 0.01 - 700.5, z * 0.01 - 700.5);
+    double shape = noise->noise(x / 24.0, y / 8.0, z / 24.0);
+    return cover + 0.3 * shape - 0.4 * falloff;
+}
+
+void ChunkGenerator::generateSky(Chunk* chunk) {
+    int bottom = chunk->worldPosition.y, top = bottom + chunkSize - 1;
+
+    // Band culling, chunks outside both bands cost nothing
+    bool inIslands = top >= islandMinHeight && bottom <= islandMaxHeight;
+    bool inClouds = top >= cloudMinHeight && bottom <= cloudMaxHeight;
+    if (!inIslands && !inClouds) return;
+
+    // Islands are sampled with 3 extra layers on top to find the grass and dirt
+    const int depth = 3;
+    const int sizeY = chunkSize + depth;
+    float density[chunkSize * sizeY * chunkSize];
+    const int sliceSize = chunkSize * sizeY;
+
+    if (inIslands) {
+        skyField.fill(chunk->worldPosition, chunkSize, sizeY, chunkSize, [this](double x, double y, double z) {
+            return islandDensity(x, y, z);
+        }, density);
+
+        for (int z = 0; z < chunkSize; z++) {
+            for (int x = 0; x < chunkSize; x++) {
+                const float* column = &density[x + z * sliceSize];
+                for (int y = 0; y < chunkSize; y++) {
+                    if (column[y * chunkSize] <= 0.0f) continue;
+
+                    // Distance to the island surface above, capped at the sampled depth
+                    int below = 0;
+                    while (below < depth && column[(y + below + 1) * chunkSize] > 0.0f) below++;
+
+                    Voxel voxel = below == 0 ? ID_GRASS : below < depth ? ID_DIRT : ID_STONE;
+                    if (chunk->addVoxel(Vec3(x, y, z), voxel)) chunk->isEmpty = false;
                 }
             }
         }
     }
+
+    if (inClouds) {
+        skyField.fill(chunk->worldPosition, chunkSize, chunkSize, chunkSize, [this](double x, double y, double z) {
+            return cloudDensity(x, y, z);
+        }, density);
+
+        for (int i = 0; i < Chunk::numVoxels; i++) {
+            if (density[i] > 0.0f && !chunk->voxels[i].isSolid()) {
+                chunk->voxels[i] = ID_CLOUD;
+                chunk->isEmpty = false;
+            }
+        }
+    }
 }
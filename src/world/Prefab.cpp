@@ -0,0 +1,125 @@
+#include "world/Prefab.h"
+
+Prefab::Prefab(const Vec3& size, const Vec3& anchor, const std::vector<Voxel>& palette)
+    : size(size), anchor(anchor), palette(palette) {
+    blocks.resize(size.x * size.y * size.z, 0);
+}
+
+void Prefab::set(const Vec3& blockPosition, uint8_t paletteIndex) {
+    if (blockPosition.x < 0 || blockPosition.x >= size.x ||
+        blockPosition.y < 0 || blockPosition.y >= size.y ||
+        blockPosition.z < 0 || blockPosition.z >= size.z) {
+        return;
+    }
+    int idx = blockPosition.x + blockPosition.y * size.x + blockPosition.z * size.x * size.y;
+    blocks[idx] = paletteIndex;
+}
+
+void Prefab::fillBox(const Vec3& min, const Vec3& max, uint8_t paletteIndex) {
+    for (int z = min.z; z <= max.z; z++) {
+        for (int y = min.y; y <= max.y; y++) {
+            for (int x = min.x; x <= max.x; x++) {
+                set(Vec3(x, y, z), paletteIndex);
+            }
+        }
+    }
+}
+
+void Prefab::compile() {
+    cells.clear();
+    int idx = 0;
+    for (int z = 0; z < size.z; z++) {
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x++, idx++) {
+                if (blocks[idx] == 0) continue;
+                PrefabCell cell;
+                cell.x = x - anchor.x;
+                cell.y = y - anchor.y;
+                cell.z = z - anchor.z;
+                cell.paletteIndex = blocks[idx];
+                cells.push_back(cell);
+            }
+        }
+    }
+}
+
+// Prefab builders, palette index 1 is wood or stone and 2 is leaves
+
+static Prefab makeTree(int trunkHeight) {
+    Prefab tree(Vec3(3, trunkHeight + 1, 3), Vec3(1, 0, 1), { ID_AIR, ID_WOOD, ID_LEAVES });
+    // Crown around the upper trunk and a leaf on top
+    for (int y = 2; y < trunkHeight; y++) {
+        tree.set(Vec3(0, y, 1), 2);
+        tree.set(Vec3(2, y, 1), 2);
+        tree.set(Vec3(1, y, 0), 2);
+        tree.set(Vec3(1, y, 2), 2);
+    }
+    tree.set(Vec3(1, trunkHeight, 1), 2);
+    tree.fillBox(Vec3(1, 0, 1), Vec3(1, trunkHeight - 1, 1), 1);
+    tree.compile();
+    return tree;
+}
+
+static Prefab makeWideTree(int trunkHeight) {
+    Prefab tree(Vec3(5, trunkHeight + 2, 5), Vec3(2, 0, 2), { ID_AIR, ID_WOOD, ID_LEAVES });
+    int crown = trunkHeight - 2;
+    tree.fillBox(Vec3(0, crown, 1), Vec3(4, crown + 1, 3), 2);
+    tree.fillBox(Vec3(1, crown, 0), Vec3(3, crown + 1, 4), 2);
+    tree.fillBox(Vec3(1, crown + 2, 1), Vec3(3, crown + 3, 3), 2);
+    tree.fillBox(Vec3(2, 0, 2), Vec3(2, trunkHeight - 1, 2), 1);
+    tree.compile();
+    return tree;
+}
+
+static Prefab makeSpruce(int trunkHeight) {
+    Prefab tree(Vec3(5, trunkHeight + 1, 5), Vec3(2, 0, 2), { ID_AIR, ID_WOOD, ID_LEAVES });
+    // Cone of leaves that narrows towards the top
+    for (int y = 2; y < trunkHeight; y++) {
+        int radius = (trunkHeight - y) / 2 > 1 ? 2 : 1;
+        tree.fillBox(Vec3(2 - radius, y, 2), Vec3(2 + radius, y, 2), 2);
+        tree.fillBox(Vec3(2, y, 2 - radius), Vec3(2, y, 2 + radius), 2);
+        if (radius > 1) tree.fillBox(Vec3(1, y, 1), Vec3(3, y, 3), 2);
+    }
+    tree.set(Vec3(2, trunkHeight, 2), 2);
+    tree.fillBox(Vec3(2, 0, 2), Vec3(2, trunkHeight - 1, 2), 1);
+    tree.compile();
+    return tree;
+}
+
+static Prefab makeRock(int radius) {
+    int size = radius * 2 + 1;
+    Prefab rock(Vec3(size, radius + 1, size), Vec3(radius, 0, radius), { ID_AIR, ID_STONE });
+    for (int z = 0; z < size; z++) {
+        for (int y = 0; y <= radius; y++) {
+            for (int x = 0; x < size; x++) {
+                float dx = x - radius, dz = z - radius;
+                if (dx * dx + y * y + dz * dz <= radius * radius + 0.5f) rock.set(Vec3(x, y, z), 1);
+            }
+        }
+    }
+    rock.compile();
+    return rock;
+}
+
+PrefabLibrary::PrefabLibrary() {
+    prefabs = {
+        makeTree(6),      // 0: the classic tree
+        makeTree(5),      // 1
+        makeTree(8),      // 2
+        makeWideTree(7),  // 3
+        makeWideTree(10), // 4
+        makeSpruce(7),    // 5
+        makeSpruce(10),   // 6
+        makeRock(1),      // 7
+        makeRock(2),      // 8
+    };
+
+    std::vector<int> trees = { 0, 1, 2 };
+    rules[PLAINS] = { { ID_GRASS, 30, trees }, { ID_GRASS, 150, { 7 } } };
+    rules[FOREST] = { { ID_GRASS, 20, { 0, 1, 2, 3 } } };
+    rules[RAINFOREST] = { { ID_GRASS, 15, { 2, 3, 4 } } };
+    rules[TAIGA] = { { ID_GRASS, 25, { 5, 6 } } };
+    rules[SNOW] = { { ID_GRASS, 60, { 5, 6 } } };
+    rules[MOUNTAINS] = { { ID_STONE, 80, { 7, 8 } } };
+    rules[DESSERT] = { { ID_SAND, 300, { 7 } } };
+}
@@ -0,0 +1,56 @@
+#include "world/VoxelCursor.h"
+#include "world/WorldManager.h"
+
+// Rounds towards negative infinity, unlike integer division
+static int floorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : (value - divisor + 1) / divisor;
+}
+
+VoxelCursor::VoxelCursor(WorldManager& world, const Vec3& worldPosition)
+    : world(world), chunkX(0), chunkY(0), chunkZ(0) {
+    localX = (int)std::floor(worldPosition.x);
+    localY = (int)std::floor(worldPosition.y);
+    localZ = (int)std::floor(worldPosition.z);
+    changeChunk();
+}
+
+void VoxelCursor::move(int dx, int dy, int dz) {
+    localX += dx;
+    localY += dy;
+    localZ += dz;
+    if ((unsigned)localX >= size || (unsigned)localY >= size || (unsigned)localZ >= size) {
+        changeChunk();
+    }
+}
+
+void VoxelCursor::moveTo(const Vec3& worldPosition) {
+    move((int)std::floor(worldPosition.x) - (chunkX * size + localX),
+         (int)std::floor(worldPosition.y) - (chunkY * size + localY),
+         (int)std::floor(worldPosition.z) - (chunkZ * size + localZ));
+}
+
+void VoxelCursor::changeChunk() {
+    int dx = floorDiv(localX, size), dy = floorDiv(localY, size), dz = floorDiv(localZ, size);
+    localX -= dx * size;
+    localY -= dy * size;
+    localZ -= dz * size;
+    chunkX += dx;
+    chunkY += dy;
+    chunkZ += dz;
+
+    // The links of a loaded chunk are exact, a missing neighbour is not loaded
+    if (chunk && std::abs(dx) <= 1 && std::abs(dy) <= 1 && std::abs(dz) <= 1) {
+        chunk = chunk->getNeighbour(dx, dy, dz);
+    } else {
+        chunk = world.getChunkAt(Vec3(chunkX, chunkY, chunkZ) * size);
+    }
+}
+
+Vec3 VoxelCursor::getPosition() const {
+    return Vec3(chunkX * size + localX, chunkY * size + localY, chunkZ * size + localZ);
+}
+
+bool VoxelCursor::isSolid() const {
+    Voxel* voxel = get();
+    return voxel && voxel->isSolid();
+}
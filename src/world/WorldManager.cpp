@@ -1,5 +1,40 @@
 #include "world/WorldManager.h"
+#include "world/VoxelCursor.h"
+#include "utilities/ScratchArena.h"
 #include <queue>
+#include <algorithm>
+
+void WorldManager::initChunkSlots() {
+    int worldEdgeLen = updateDistance * 2 + 1;
+    numChunks = worldEdgeLen * worldEdgeLen * worldEdgeLen;
+    chunks = new Chunk*[numChunks]();
+    shiftedChunks = new Chunk*[numChunks]();
+    int numVoxels = chunkSize * chunkSize * chunkSize;
+    for (int i = 0; i < numChunks; i++) {
+        int offset = i * numVoxels;
+        availableOffsets.push(offset);
+    }
+}
+
+WorldManager::~WorldManager() {
+    // Workers write to the chunks, columns and completion lists of this world.
+    // With the queue empty the generation slots end after their current chunk
+    {
+        std::lock_guard<std::mutex> lock(generationMutex);
+        generationQueue.clear();
+    }
+    activeChunks.forEach([](const Vec3&, const std::shared_ptr<Chunk>& chunk) {
+        chunk->cancelled = true;
+    });
+    while (tasksRunning.load() > 0) {
+        std::this_thread::yield();
+    }
+    for (auto& [chunkPos, waiters] : chunkWaiters) {
+        for (Promise<bool>& waiter : waiters) waiter.set(false);
+    }
+    delete[] chunks;
+    delete[] shiftedChunks;
+}
 
 Vec3 WorldManager::worldToChunkPosition(const Vec3& worldPosition) const {
     return floor(worldPosition / chunkSize);
@@ -7,115 +42,536 @@ Vec3 WorldManager::worldToChunkPosition(const Vec3& worldPosition) const {
 
 Chunk* WorldManager::addChunk(const Vec3& chunkPosition, int bufferOffset) {
     Vec3 worldPosition = chunkPosition * chunkSize;
-    activeChunks[chunkPosition] = std::make_unique<Chunk>(worldPosition, bufferOffset);
-    return activeChunks[chunkPosition].get();
+    auto chunk = std::make_shared<Chunk>(worldPosition, bufferOffset);
+    activeChunks.insert(chunkPosition, chunk);
+    return chunk.get();
 }
 
 Chunk* WorldManager::getChunk(const Vec3& chunkPosition) const {
-    auto it = activeChunks.find(chunkPosition);
-    if (it != activeChunks.end()) {
-        return it->second.get();
+    Chunk* chunk = nullptr;
+    activeChunks.read(chunkPosition, [&chunk](const std::shared_ptr<Chunk>& found) { chunk = found.get(); });
+    return chunk;
+}
+
+Chunk* WorldManager::getChunkAt(const Vec3& worldPosition) const {
+    return getChunk(worldToChunkPosition(worldPosition));
+}
+
+std::shared_ptr<Chunk> WorldManager::findChunk(const Vec3& worldPosition) const {
+    std::shared_ptr<Chunk> chunk;
+    activeChunks.read(worldToChunkPosition(worldPosition), [&chunk](const std::shared_ptr<Chunk>& found) { chunk = found; });
+    return chunk;
+}
+
+Future<bool> WorldManager::whenChunkDone(const Vec3& worldPosition) {
+    Promise<bool> promise;
+    Chunk* chunk = getChunkAt(worldPosition);
+    if (!chunk || chunk->state == DONE) {
+        promise.set(chunk != nullptr);
+    } else {
+        chunkWaiters[worldToChunkPosition(worldPosition)].push_back(promise);
+    }
+    return promise.getFuture();
+}
+
+void WorldManager::notifyChunkWaiters(const Vec3& chunkPosition, bool isDone) {
+    if (chunkWaiters.empty()) return;
+    auto it = chunkWaiters.find(chunkPosition);
+    if (it == chunkWaiters.end()) return;
+    std::vector<Promise<bool>> waiters = std::move(it->second);
+    chunkWaiters.erase(it);
+    for (Promise<bool>& waiter : waiters) {
+        waiter.set(isDone);
     }
-    return nullptr;
 }
 
 ChunkColumn* WorldManager::addColumn(Vec2 columnPosition) {
-    activeColumns[columnPosition] = std::make_unique<ChunkColumn>(columnPosition * chunkSize);
-    return activeColumns[columnPosition].get();
+    auto column = std::make_unique<ChunkColumn>(columnPosition * chunkSize);
+    ChunkColumn* added = column.get();
+    activeColumns.insert(columnPosition, std::move(column));
+    return added;
 }
 
 ChunkColumn* WorldManager::getColumn(Vec2 columnPosition) const {
-    auto it = activeColumns.find(columnPosition);
-    if (it != activeColumns.end()) {
-        return it->second.get();
-    }
-    return nullptr;
+    ChunkColumn* column = nullptr;
+    activeColumns.read(columnPosition, [&column](const std::unique_ptr<ChunkColumn>& found) { column = found.get(); });
+    return column;
 }
 
 void WorldManager::updateChunks(Vec3 worldCenter) {
+    updateChunksAround(worldCenter, nullptr);
+}
+
+void WorldManager::updateChunks(const Camera& camera) {
+    updateChunksAround(camera.position, &camera);
+}
+
+void WorldManager::updateChunksAround(const Vec3& worldCenter, const Camera* camera) {
     Vec3 centerChunkPos = worldToChunkPosition(worldCenter);
     AABB activeBox = {Vec3(centerChunkPos - Vec3(updateDistance)), Vec3(centerChunkPos + Vec3(updateDistance))};
     AABB2D activeBox2D = {activeBox.min.xz(), activeBox.max.xz()};
     worldBasePos = activeBox.min * chunkSize;
 
-    // cleanup out of range chunks
-    std::vector<Vec3> chunksToRemove;
-    for (auto& [chunkPos, chunk] : activeChunks) {
-        if (!AABBpointIn(chunkPos, activeBox) && chunk->state != PENDING) {
-            chunksToRemove.push_back(chunkPos);
-        }
+    // Temporary lists of this update come from the thread's scratch arena, freed when it returns
+    ScratchScope frameScratch;
+
+    // The loaded chunks only change when the center moves to another chunk, 
+    // or when a chunk could not be loaded for lack of a buffer slot
+    if (!hasActiveBox || activeBox.min != lastActiveBox.min || missingChunks > 0) {
+        moveActiveBox(activeBox);
     }
-    for (auto chunkPos : chunksToRemove) {
-        availableOffsets.push(getChunk(chunkPos)->bufferOffset);
-        auto column = getColumn(chunkPos.xz());
-        column->dependencyCount--;
-        activeChunks.erase(chunkPos);
+    if (!staleColumns.empty()) {
+        removeStaleColumns(activeBox2D);
     }
+    scheduleColumnTiles();
+
+    // advance only the chunks whose dependencies changed
+    processCompletions();
+    dispatchGeneration(worldCenter, camera);
+    processFinishQueue();
+    updatePendingWrites(activeBox);
+}
 
-    // cleanup out of range columns
-    std::vector<Vec2> columnsToRemove;
-    for (auto& [columnPos, column] : activeColumns) {
-        if (!AABBpointIn2D(columnPos, activeBox2D) && column->dependencyCount == 0) {
-            columnsToRemove.push_back(columnPos);
+int WorldManager::chunkIndex(const Vec3& chunkPosition, const AABB& box) const {
+    int edge = updateDistance * 2 + 1;
+    Vec3 offset = chunkPosition - box.min;
+    return (int)offset.x + (int)offset.y * edge + (int)offset.z * edge * edge;
+}
+
+void WorldManager::moveActiveBox(const AABB& activeBox) {
+    std::pmr::memory_resource* scratch = &ScratchArena::forThread();
+    bool hadBox = hasActiveBox;
+    AABB oldBox = lastActiveBox;
+
+    // Unload the chunks in the slabs that left the box, cancelling the ones still generating.
+    // Every loaded chunk is in the flat array, so they are found without looking them up
+    std::pmr::vector<Chunk*> chunksToRemove(scratch);
+    if (hadBox) {
+        for (int z = (int)oldBox.min.z; z <= (int)oldBox.max.z; z++) {
+            for (int y = (int)oldBox.min.y; y <= (int)oldBox.max.y; y++) {
+                for (int x = (int)oldBox.min.x; x <= (int)oldBox.max.x; x++) {
+                    Vec3 chunkPos(x, y, z);
+                    if (AABBpointIn(chunkPos, activeBox)) continue;
+                    Chunk* chunk = chunks[chunkIndex(chunkPos, oldBox)];
+                    if (chunk) chunksToRemove.push_back(chunk);
+                }
+            }
         }
+
+        // Columns that left are removed once no chunk or tile task uses them
+        AABB2D activeBox2D = {activeBox.min.xz(), activeBox.max.xz()};
+        for (int z = (int)oldBox.min.z; z <= (int)oldBox.max.z; z++) {
+            for (int x = (int)oldBox.min.x; x <= (int)oldBox.max.x; x++) {
+                Vec2 columnPos(x, z);
+                if (!AABBpointIn2D(columnPos, activeBox2D)) {
+                    staleColumns.push_back(columnPos);
+                }
+            }
+        }
+    }
+    // Once out of the generation queue no worker can start them, so their state stays put while unloading
+    if (!chunksToRemove.empty()) {
+        std::pmr::unordered_set<Chunk*> removed(chunksToRemove.begin(), chunksToRemove.end(), 
+                                                chunksToRemove.size(), std::hash<Chunk*>(), 
+                                                std::equal_to<Chunk*>(), scratch);
+        auto isRemoved = [&removed](const QueuedChunk& queued) { return removed.count(queued.chunk) > 0; };
+        scheduledChunks.erase(std::remove_if(scheduledChunks.begin(), scheduledChunks.end(), isRemoved), 
+                              scheduledChunks.end());
+        std::lock_guard<std::mutex> lock(generationMutex);
+        generationQueue.erase(std::remove_if(generationQueue.begin(), generationQueue.end(), isRemoved), 
+                              generationQueue.end());
     }
-    for (auto columnPos : columnsToRemove) {
-        activeColumns.erase(columnPos);
+    for (Chunk* chunk : chunksToRemove) {
+        unloadChunk(chunk, activeBox);
     }
 
-    // update and generate new chunks, and update the flat chunk array
+    // Shift the flat chunk array, chunks that stayed are copied and only the slabs that entered are loaded
+    missingChunks = 0;
     int idx = 0;
-    for (int z = -updateDistance; z <= updateDistance; z++) {
-        for (int y = -updateDistance; y <= updateDistance; y++) {
-            for (int x = -updateDistance; x <= updateDistance; x++, idx++) {
-                Vec3 chunkPos = centerChunkPos + Vec3(x, y, z);
-                auto chunk = getChunk(chunkPos);
-                if (!chunk) {
-                    if (availableOffsets.empty()) continue;
-
+    for (int z = (int)activeBox.min.z; z <= (int)activeBox.max.z; z++) {
+        for (int y = (int)activeBox.min.y; y <= (int)activeBox.max.y; y++) {
+            for (int x = (int)activeBox.min.x; x <= (int)activeBox.max.x; x++, idx++) {
+                Vec3 chunkPos(x, y, z);
+                Chunk* chunk = nullptr;
+                if (hadBox && AABBpointIn(chunkPos, oldBox)) {
+                    chunk = chunks[chunkIndex(chunkPos, oldBox)];
+                }
+                if (!chunk && !availableOffsets.empty()) {
                     int offset = availableOffsets.front();
                     availableOffsets.pop();
-                    chunk = addChunk(chunkPos, offset);
-                    
-                    auto column = getColumn(chunkPos.xz());
-                    if (!column) {
-                        column = addColumn(chunkPos.xz());
-                        chunkGenerator.generateChunkColumn(column);
-                    }
-                    column->dependencyCount++;
-                    
-                    chunk->state = PENDING;
-                    threadManager.addTask([this, chunk]() {
-                        chunkGenerator.generateChunk(chunk);
-                    });
-                } 
-                chunks[idx] = chunk;
+                    loadChunk(chunkPos, offset);
+                    chunk = getChunk(chunkPos);
+                }
+                if (!chunk) missingChunks++;
+                shiftedChunks[idx] = chunk;
             }
         }  
     }
+    std::swap(chunks, shiftedChunks);
 
-    // Generate features for chunks where all neighbours are initiated
-    for (int i = 0; i < numChunks; i++) {
-        auto chunk = chunks[i];
-        if (chunk && chunk->state == GENERATED && neighboursReady(chunk)) {
-            chunkGenerator.generateFeatures(chunk);
+    hasActiveBox = true;
+    lastActiveBox = activeBox;
+}
+
+void WorldManager::removeStaleColumns(const AABB2D& activeBox2D) {
+    staleColumns.erase(std::remove_if(staleColumns.begin(), staleColumns.end(), [&](const Vec2& columnPos) {
+        // Back in range, or already removed through an earlier entry
+        if (AABBpointIn2D(columnPos, activeBox2D)) return true;
+        ChunkColumn* column = getColumn(columnPos);
+        if (!column) return true;
+
+        if (column->dependencyCount == 0 && column->isGenerated) {
+            activeColumns.erase(columnPos);
+            return true;
         }
+        return false;
+    }), staleColumns.end());
+}
+
+void WorldManager::forEachNeighbour(Chunk* chunk, const std::function<void(Chunk*)>& callback) {
+    for (int i = 0; i < Chunk::numNeighbours; i++) {
+        Chunk* neighbour = chunk->neighbours[i];
+        if (neighbour && i != Chunk::selfIndex) callback(neighbour);
     }
 }
 
-bool WorldManager::neighboursReady(Chunk* chunk) {
-    Vec3 centerChunkPos = worldToChunkPosition(chunk->worldPosition);
-    for (int x = -1; x <= 1; x++) {
+void WorldManager::linkNeighbours(Chunk* chunk, const Vec3& chunkPosition) {
+    for (int z = -1; z <= 1; z++) {
         for (int y = -1; y <= 1; y++) {
-            for (int z = -1; z <= 1; z++) {
-                if (x == 0 && y == 0 && z == 0) continue;
-                Vec3 chunkPos = centerChunkPos + Vec3(x, y, z);
-                Chunk* neighbour = getChunk(chunkPos);
-                if (!neighbour || neighbour->state == PENDING) return false;
+            for (int x = -1; x <= 1; x++) {
+                int i = Chunk::neighbourIndex(x, y, z);
+                if (i == Chunk::selfIndex) continue;
+                Chunk* neighbour = getChunk(chunkPosition + Vec3(x, y, z));
+                if (!neighbour) continue;
+                chunk->neighbours[i] = neighbour;
+                neighbour->neighbours[Chunk::oppositeIndex(i)] = chunk;
+            }
+        }
+    }
+}
+
+void WorldManager::unlinkNeighbours(Chunk* chunk) {
+    for (int i = 0; i < Chunk::numNeighbours; i++) {
+        Chunk* neighbour = chunk->neighbours[i];
+        if (!neighbour || i == Chunk::selfIndex) continue;
+        neighbour->neighbours[Chunk::oppositeIndex(i)] = nullptr;
+        chunk->neighbours[i] = nullptr;
+    }
+}
+
+void WorldManager::loadChunk(const Vec3& chunkPosition, int bufferOffset) {
+    Chunk* chunk = addChunk(chunkPosition, bufferOffset);
+    chunk->state.store(PENDING, std::memory_order_release);
+    linkNeighbours(chunk, chunkPosition);
+
+    // The new chunk has no features yet, so it holds back the finishing of its neighbours
+    forEachNeighbour(chunk, [chunk](Chunk* neighbour) {
+        if (neighbour->state == PENDING || neighbour->state == GENERATING) {
+            chunk->pendingNeighbours++;
+        }
+        if (neighbour->state != DONE) {
+            neighbour->pendingNeighbours++;
+        }
+    });
+
+    auto column = getColumn(chunkPosition.xz());
+    if (!column) {
+        column = addColumn(chunkPosition.xz());
+        newColumns.push_back(column);
+    }
+    column->dependencyCount++;
+
+    if (column->isGenerated) {
+        scheduleChunk(chunk);
+    } else {
+        column->waitingChunks.push_back(chunk);
+    }
+}
+
+void WorldManager::unloadChunk(Chunk* chunk, const AABB& activeBox) {
+    Vec3 chunkPos = worldToChunkPosition(chunk->worldPosition);
+    ChunkColumn* column = getColumn(chunkPos.xz());
+
+    // Nothing is uploaded from a chunk that is not done, so its slot is free right away
+    availableOffsets.push(chunk->bufferOffset);
+    notifyChunkWaiters(chunkPos, false);
+
+    if (chunk->state == PENDING || chunk->state == GENERATING) {
+        // The chunk never finished its features, release the neighbours it held back.
+        // Neighbours outside the active box are unloaded in this update too
+        forEachNeighbour(chunk, [this, &activeBox](Chunk* neighbour) {
+            if (neighbour->state == DONE || !AABBpointIn(worldToChunkPosition(neighbour->worldPosition), activeBox)) return;
+            if (--neighbour->pendingNeighbours == 0 && neighbour->state == GENERATED) {
+                finishQueue.push_back(neighbour);
+            }
+        });
+    }
+    unlinkNeighbours(chunk);
+
+    if (chunk->state == GENERATING) {
+        // A worker still uses the chunk and its column, keep both until it reports back
+        chunk->cancelled = true;
+        std::shared_ptr<Chunk> cancelled;
+        activeChunks.take(chunkPos, cancelled);
+        cancelledChunks.push_back(std::move(cancelled));
+        return;
+    }
+
+    if (chunk->state == PENDING && !column->isGenerated) {
+        auto& waiting = column->waitingChunks;
+        waiting.erase(std::remove(waiting.begin(), waiting.end(), chunk), waiting.end());
+    }
+    column->dependencyCount--;
+    activeChunks.erase(chunkPos);
+}
+
+void WorldManager::scheduleColumnTiles() {
+    // Group the new columns by tile, one task per tile
+    // Only the map is scratch, the column lists move into the tasks
+    std::pmr::unordered_map<Vec2, std::vector<ChunkColumn*>, Vec2Hash> tiles(&ScratchArena::forThread());
+    for (ChunkColumn* column : newColumns) {
+        Vec2 columnPos = column->worldPosition2D / chunkSize;
+        tiles[floor(columnPos / columnTileSize)].push_back(column);
+    }
+    newColumns.clear();
+
+    for (auto& [tilePos, columns] : tiles) {
+        tasksRunning++;
+        threadManager.addTask([this, columns = std::move(columns)]() {
+            chunkGenerator.generateColumnTile(columns);
+            for (size_t i = 0; i + 1 < columns.size(); i++) {
+                columns[i]->nextCompleted = columns[i + 1];
+            }
+            completedColumns.push(columns.front(), columns.back());
+            tasksRunning--;
+        }, TASK_COLUMN);
+    }
+}
+
+void WorldManager::scheduleChunk(Chunk* chunk) {
+    chunk->stage = STAGE_COLUMN;
+
+    // Workers get the column directly, the column map is only touched by the main thread
+    ChunkColumn* column = getColumn(worldToChunkPosition(chunk->worldPosition).xz());
+    scheduledChunks.push_back({ chunk, column });
+}
+
+void WorldManager::dispatchGeneration(const Vec3& viewPosition, const Camera* camera) {
+    // Rank a copy of the queue, workers keep taking chunks from it meanwhile
+    std::pmr::vector<std::pair<float, QueuedChunk>> ranked(&ScratchArena::forThread());
+    {
+        std::lock_guard<std::mutex> lock(generationMutex);
+        if (generationQueue.empty() && scheduledChunks.empty()) return;
+        ranked.reserve(generationQueue.size() + scheduledChunks.size());
+        for (const QueuedChunk& queued : generationQueue) {
+            ranked.push_back({ 0.0f, queued });
+        }
+    }
+    for (const QueuedChunk& queued : scheduledChunks) {
+        ranked.push_back({ 0.0f, queued });
+    }
+    scheduledChunks.clear();
+
+    // Closest first, chunks in view count as four times closer
+    const float chunkRadius = chunkSize * 0.87f;
+    for (auto& [priority, queued] : ranked) {
+        Vec3 center = queued.chunk->worldPosition + Vec3(chunkSize * 0.5f);
+        Vec3 offset = center - viewPosition;
+        priority = dot(offset, offset);
+        if (camera && camera->sphereInView(center, chunkRadius)) {
+            priority *= 0.25f;
+        }
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    // Chunks taken while ranking are generating now and stay out
+    int slots;
+    {
+        std::lock_guard<std::mutex> lock(generationMutex);
+        generationQueue.clear();
+        for (const auto& [priority, queued] : ranked) {
+            if (queued.chunk->state == PENDING) {
+                generationQueue.push_back(queued);
+            }
+        }
+        slots = std::min((int)generationQueue.size(), 
+                         (int)threadManager.getNumThreads() * generationSlotsPerThread - generationSlots);
+        slots = std::max(slots, 0);
+        generationSlots += slots;
+    }
+
+    for (int i = 0; i < slots; i++) {
+        tasksRunning++;
+        threadManager.addTask([this]() { generateNextChunk(); }, TASK_TERRAIN);
+    }
+}
+
+void WorldManager::generateNextChunk() {
+    QueuedChunk next = { nullptr, nullptr };
+    {
+        std::lock_guard<std::mutex> lock(generationMutex);
+        if (generationQueue.empty()) {
+            generationSlots--;
+        } else {
+            next = generationQueue.back();
+            generationQueue.pop_back();
+            next.chunk->state.store(GENERATING, std::memory_order_release);
+        }
+    }
+
+    // Nothing left, the slot ends. Counted out after the lock, the destructor may run next
+    if (!next.chunk) {
+        tasksRunning--;
+        return;
+    }
+
+    Chunk* chunk = next.chunk;
+    ChunkColumn* column = next.column;
+    if (!chunkGenerator.generateChunkTerrain(chunk, column)) {
+        completedChunks.push(chunk);
+        threadManager.addTask([this]() { generateNextChunk(); }, TASK_TERRAIN);
+        return;
+    }
+
+    // Added from the worker, so it lands on its own queue with the chunk still in cache
+    threadManager.addTask([this, chunk, column]() {
+        chunkGenerator.generateChunkFeatures(chunk, column);
+        completedChunks.push(chunk);
+        threadManager.addTask([this]() { generateNextChunk(); }, TASK_TERRAIN);
+    }, TASK_FEATURES);
+}
+
+void WorldManager::processCompletions() {
+    completedColumns.takeAll([this](ChunkColumn* column) {
+        column->isGenerated = true;
+        for (Chunk* chunk : column->waitingChunks) {
+            scheduleChunk(chunk);
+        }
+        column->waitingChunks.clear();
+    });
+
+    completedChunks.takeAll([this](Chunk* chunk) {
+        if (chunk->cancelled) {
+            // Unloaded while generating, the worker is done with it and its column now
+            getColumn(worldToChunkPosition(chunk->worldPosition).xz())->dependencyCount--;
+            auto it = std::find_if(cancelledChunks.begin(), cancelledChunks.end(), 
+                                   [chunk](const std::shared_ptr<Chunk>& cancelled) { return cancelled.get() == chunk; });
+            cancelledChunks.erase(it);
+            return;
+        }
+
+        chunk->state.store(GENERATED, std::memory_order_release);
+
+        forEachNeighbour(chunk, [this](Chunk* neighbour) {
+            if (neighbour->state != DONE && --neighbour->pendingNeighbours == 0 && neighbour->state == GENERATED) {
+                finishQueue.push_back(neighbour);
             }
+        });
+        if (chunk->pendingNeighbours == 0) {
+            finishQueue.push_back(chunk);
+        }
+    });
+}
+
+void WorldManager::processFinishQueue() {
+    for (Chunk* chunk : finishQueue) {
+        if (!frameJobs) {
+            finishChunk(chunk);
+            continue;
         }
+
+        // Before the job runs the chunk can be unloaded, or held back again by a new neighbour
+        Vec3 chunkPos = worldToChunkPosition(chunk->worldPosition);
+        frameJobs->add([this, chunkPos]() {
+            Chunk* chunk = getChunk(chunkPos);
+            if (chunk && chunk->state == GENERATED && chunk->pendingNeighbours == 0) {
+                finishChunk(chunk);
+            }
+        });
+    }
+    finishQueue.clear();
+}
+
+void WorldManager::finishChunk(Chunk* chunk) {
+    // Every neighbour that is loaded has written its features, 
+    // so the deferred writes for this chunk are complete
+    applyPendingWrites(chunk);
+    chunk->stage = STAGE_UPLOAD_READY;
+    chunk->state.store(DONE, std::memory_order_release);
+    chunk->isDirty = true;
+
+    notifyChunkWaiters(worldToChunkPosition(chunk->worldPosition), true);
+}
+
+void WorldManager::deferVoxels(const Vec3& chunkPosition, const PendingWrite* writes, size_t count) {
+    if (count == 0) return;
+
+    // Whoever makes the writes for a chunk non empty reports it, the map itself is never scanned.
+    // Reported under the shard's lock, so the writes can not be taken in between
+    pendingWrites.update(chunkPosition, [&](std::vector<PendingWrite>& pending) {
+        if (pending.empty()) {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            pendingTargets.push_back(chunkPosition);
+        }
+        pending.insert(pending.end(), writes, writes + count);
+    });
+}
+
+void WorldManager::applyPendingWrites(Chunk* chunk) {
+    std::vector<PendingWrite> writes;
+    if (!pendingWrites.take(worldToChunkPosition(chunk->worldPosition), writes)) return;
+
+    // Workers defer writes in whatever order they finish, and the first write to a voxel
+    // wins, so apply them in a fixed order to keep the world the same for a given seed
+    std::sort(writes.begin(), writes.end(), [](const PendingWrite& a, const PendingWrite& b) {
+        const Vec3& pa = a.localPosition;
+        const Vec3& pb = b.localPosition;
+        if (pa.z != pb.z) return pa.z < pb.z;
+        if (pa.y != pb.y) return pa.y < pb.y;
+        if (pa.x != pb.x) return pa.x < pb.x;
+        return a.voxel.data < b.voxel.data;
+    });
+
+    for (const PendingWrite& write : writes) {
+        if (chunk->addVoxel(write.localPosition, write.voxel)) {
+            chunk->isDirty = true;
+            chunk->isEmpty = false;
+        }
+    }
+}
+
+void WorldManager::updatePendingWrites(const AABB& activeBox) {
+    // Copied rather than swapped, so pendingTargets keeps its capacity
+    std::pmr::vector<Vec3> targets(&ScratchArena::forThread());
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        targets.assign(pendingTargets.begin(), pendingTargets.end());
+        pendingTargets.clear();
+    }
+
+    // Writes are kept one chunk past the active box, since chunks there can 
+    // still come back while the chunk that wrote them stays loaded
+    AABB keepBox = { activeBox.min - Vec3(1), activeBox.max + Vec3(1) };
+    std::pmr::vector<Vec3> waiting(&ScratchArena::forThread());
+    for (const Vec3& chunkPos : targets) {
+        // Finished chunks take their writes when they are done, which can leave a target behind
+        if (!pendingWrites.read(chunkPos, [](const std::vector<PendingWrite>&) {})) continue;
+
+        Chunk* chunk = getChunk(chunkPos);
+        if (chunk && chunk->state == DONE) {
+            applyPendingWrites(chunk);
+        } else if (chunk || AABBpointIn(chunkPos, keepBox)) {
+            // Still generating or not loaded yet, applied once it is generated
+            waiting.push_back(chunkPos);
+        } else {
+            pendingWrites.erase(chunkPos);
+        }
+    }
+
+    if (!waiting.empty()) {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pendingTargets.insert(pendingTargets.end(), waiting.begin(), waiting.end());
     }
-    return true;
 }
 
 // Voxel operations
@@ -167,8 +623,11 @@ bool WorldManager::worldRayDetection(const Vec3& startPoint, const Vec3& endPoin
 
     voxelPos = floor(startPoint);
     normal = Vec3(0, 0, 0);
+
+    // The ray moves one voxel at a time, the cursor follows without chunk lookups
+    VoxelCursor cursor(*this, voxelPos);
     while (tEntry <= rayLength) {
-        auto voxel = getVoxel(voxelPos);
+        auto voxel = cursor.get();
         if (voxel && voxel->isSolid()) {
             return true;
         }
@@ -188,10 +647,13 @@ bool WorldManager::worldRayDetection(const Vec3& startPoint, const Vec3& endPoin
 
         if (AABBrayDetection(rayPos, rayDir, voxelBoxX, normal, tEntryNext, tExit)) {
             voxelPos = voxelPosX;
+            cursor.move((int)step.x, 0, 0);
         } else if (AABBrayDetection(rayPos, rayDir, voxelBoxY, normal, tEntryNext, tExit)) {
             voxelPos = voxelPosY;
+            cursor.move(0, (int)step.y, 0);
         } else if (AABBrayDetection(rayPos, rayDir, voxelBoxZ, normal, tEntryNext, tExit)) {
             voxelPos = voxelPosZ;
+            cursor.move(0, 0, (int)step.z);
         } else {
             return false;
         }
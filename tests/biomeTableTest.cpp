@@ -0,0 +1,59 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include "world/Biomes.h"
+
+// Checks that the baked climate table picks the same biome as the if-chain it replaced,
+// on a grid of climates and on every range edge and the floats right next to it
+
+BiomeType ifChainBiome(float height, float humid, float temp) {
+    if (height < 0.45) return OCEAN;
+    if (height > 0.6) return MOUNTAINS;
+    if (humid > 0.5) {
+        if (temp > 0.66) return RAINFOREST;
+        if (temp > 0.33) return FOREST;
+        return TAIGA;
+    }
+    if (temp > 0.66) return DESSERT;
+    if (temp > 0.33) return PLAINS;
+    return SNOW;
+}
+
+// Values to test on one axis: a grid, and each edge with the floats around it
+std::vector<float> axisValues(const std::vector<float>& edges) {
+    std::vector<float> values;
+    for (int i = -2; i <= 12; i++) {
+        values.push_back(i * 0.1f);
+    }
+    for (float edge : edges) {
+        values.push_back(std::nextafter(edge, -1.0f));
+        values.push_back(edge);
+        values.push_back(std::nextafter(edge, 2.0f));
+    }
+    return values;
+}
+
+int main(int argc, char* argv[]) {
+    BiomeTable table(defaultBiomes());
+    std::vector<float> heights = axisValues({ 0.45f, 0.6f });
+    std::vector<float> humids = axisValues({ 0.5f });
+    std::vector<float> temps = axisValues({ 0.33f, 0.66f });
+
+    int mismatches = 0;
+    for (float height : heights) {
+        for (float humid : humids) {
+            for (float temp : temps) {
+                if (table.lookup(height, humid, temp) != ifChainBiome(height, humid, temp)) {
+                    if (mismatches++ < 5) {
+                        std::cerr << "biome differs at height " << height << " humidity " << humid
+                                  << " temperature " << temp << std::endl;
+                    }
+                }
+            }
+        }
+    }
+
+    bool passed = mismatches == 0;
+    std::cout << (passed ? "biomeTableTest passed" : "biomeTableTest FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+#include <iostream>
+#include <cmath>
+#include "utilities/DensityField.h"
+#include "utilities/PerlinNoise.h"
+
+// Checks that the coarse lattice density field stays within a known error
+// of the exact per-voxel density used for caves
+
+const int size = 16;
+const int numVoxels = size * size * size;
+
+PerlinNoise perlin = PerlinNoise(1337);
+
+double caveDensity(double x, double y, double z) {
+    return perlin.noise(x / size, y / size, z / size);
+}
+
+// Returns the largest absolute error of the field over a few chunks
+float maxError(const DensityField& field) {
+    float exact[numVoxels];
+    float approx[numVoxels];
+    float maxErr = 0.0f;
+    const Vec3 origins[4] = { Vec3(0, 0, 0), Vec3(-16, 32, 48), Vec3(160, 112, -80), Vec3(-4000, 64, 2048) };
+    for (const Vec3& origin : origins) {
+        DensityField(1).fill(origin, size, size, size, caveDensity, exact);
+        field.fill(origin, size, size, size, caveDensity, approx);
+        for (int i = 0; i < numVoxels; i++) {
+            maxErr = std::max(maxErr, std::abs(exact[i] - approx[i]));
+        }
+    }
+    return maxErr;
+}
+
+bool testExactSampling() {
+    float out[numVoxels];
+    Vec3 origin(32, -16, 64);
+    DensityField(1).fill(origin, size, size, size, caveDensity, out);
+    int idx = 0;
+    for (int z = 0; z < size; z++) {
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++, idx++) {
+                float expected = caveDensity(origin.x + x, origin.y + y, origin.z + z);
+                if (out[idx] != expected) {
+                    std::cerr << "step 1 differs from direct sampling at index " << idx << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool testLatticePointsExact() {
+    const int step = 4;
+    float out[numVoxels];
+    Vec3 origin(48, 96, -32);
+    DensityField(step).fill(origin, size, size, size, caveDensity, out);
+    for (int z = 0; z < size; z += step) {
+        for (int y = 0; y < size; y += step) {
+            for (int x = 0; x < size; x += step) {
+                float expected = caveDensity(origin.x + x, origin.y + y, origin.z + z);
+                float value = out[x + y * size + z * size * size];
+                if (std::abs(value - expected) > 1e-6f) {
+                    std::cerr << "lattice point (" << x << ", " << y << ", " << z << ") is not exact" << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool testErrorBounds() {
+    // Bounds for the cave frequency (one noise period per chunk)
+    const int steps[3] = { 2, 4, 8 };
+    const float bounds[3] = { 0.05f, 0.15f, 0.45f };
+    bool passed = true;
+    for (int i = 0; i < 3; i++) {
+        float err = maxError(DensityField(steps[i]));
+        std::cout << "lattice step " << steps[i] << ": max error " << err << " (bound " << bounds[i] << ")" << std::endl;
+        if (err > bounds[i]) {
+            std::cerr << "lattice step " << steps[i] << " exceeds its error bound" << std::endl;
+            passed = false;
+        }
+    }
+    return passed;
+}
+
+bool testNonCubicBlock() {
+    // Blocks that are not a multiple of the step, like a chunk plus one layer
+    const int sx = 16, sy = 17, sz = 16;
+    float exact[sx * sy * sz];
+    float approx[sx * sy * sz];
+    Vec3 origin(0, 200, 0);
+    DensityField(1).fill(origin, sx, sy, sz, caveDensity, exact);
+    DensityField(4).fill(origin, sx, sy, sz, caveDensity, approx);
+    for (int i = 0; i < sx * sy * sz; i++) {
+        if (std::abs(exact[i] - approx[i]) > 0.15f) {
+            std::cerr << "non cubic block exceeds the error bound at index " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    bool passed = true;
+    passed &= testExactSampling();
+    passed &= testLatticePointsExact();
+    passed &= testErrorBounds();
+    passed &= testNonCubicBlock();
+
+    std::cout << (passed ? "densityFieldTest passed" : "densityFieldTest FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "utilities/FrameJobQueue.h"
+
+// Checks that the frame job queue stops at its budget, keeps the order of the
+// jobs across frames and always makes progress
+
+void sleepMs(double ms) {
+    std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(ms));
+}
+
+bool testBudgetCarriesOver() {
+    const int numJobs = 10;
+    FrameJobQueue queue(2.0);
+    std::vector<int> order;
+    for (int i = 0; i < numJobs; i++) {
+        queue.add([&order, i]() {
+            sleepMs(1.0);
+            order.push_back(i);
+        });
+    }
+
+    queue.run();
+    const FrameJobStats& stats = queue.getStats();
+    if (stats.ran == 0 || stats.ran >= numJobs || stats.deferred != numJobs - stats.ran) {
+        std::cerr << "first frame ran " << stats.ran << " and deferred " << stats.deferred << " of "
+                  << numJobs << " 1 ms jobs with a 2 ms budget" << std::endl;
+        return false;
+    }
+    int firstDeferred = stats.deferred;
+
+    int frames = 1;
+    while (queue.size() > 0 && frames < numJobs) {
+        queue.run();
+        frames++;
+    }
+    if (queue.size() != 0 || stats.deferredFrames != frames - 1 || stats.peakDeferred != firstDeferred) {
+        std::cerr << "queue did not drain over " << frames << " frames" << std::endl;
+        return false;
+    }
+    for (int i = 0; i < numJobs; i++) {
+        if (order[i] != i) {
+            std::cerr << "jobs ran out of order across frames" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testSlowJobStillRuns() {
+    // A job longer than the whole budget runs on its own in a frame
+    FrameJobQueue queue(0.5);
+    int ran = 0;
+    queue.add([&ran]() { sleepMs(2.0); ran++; });
+    queue.add([&ran]() { ran++; });
+
+    queue.run();
+    if (ran != 1 || queue.getStats().deferred != 1) {
+        std::cerr << "a job over budget should run alone, ran " << ran << std::endl;
+        return false;
+    }
+    queue.run();
+    if (ran != 2 || queue.getStats().deferred != 0) {
+        std::cerr << "the job after a slow one did not run the next frame" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    bool passed = true;
+    passed &= testBudgetCarriesOver();
+    passed &= testSlowJobStillRuns();
+
+    std::cout << (passed ? "frameJobQueueTest passed" : "frameJobQueueTest FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
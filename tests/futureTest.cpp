@@ -0,0 +1,86 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "utilities/ThreadManager.h"
+#include "utilities/FrameJobQueue.h"
+#include "world/WorldManager.h"
+
+// Checks futures returned by the thread manager, continuations on workers,
+// inline and on the main thread's frame jobs, and waiting for a chunk
+
+bool testChain() {
+    ThreadManager pool(2);
+    Future<int> result = pool.submit([]() { return 2; })
+        .then(pool, [](const int& value) { return value * 3; })
+        .then([](const int& value) { return value + 1; });
+    if (result.get() != 7) {
+        std::cerr << "chained futures returned " << result.get() << " instead of 7" << std::endl;
+        return false;
+    }
+
+    // Void steps in the chain, and a continuation added after the future finished
+    std::atomic<int> steps(0);
+    Future<void> done = pool.submit([&steps]() { steps++; }).then(pool, [&steps]() { steps++; });
+    done.wait();
+    done.then([&steps]() { steps++; }).wait();
+    if (steps != 3) {
+        std::cerr << "void continuations ran " << steps << " of 3 times" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testMainThreadContinuation() {
+    ThreadManager pool(2);
+    FrameJobQueue frameJobs(2.0);
+    std::thread::id mainThread = std::this_thread::get_id();
+    std::atomic<bool> onMainThread(false);
+
+    Future<void> published = pool.submit([]() { return 5; })
+        .then(frameJobs, [&](const int& value) { onMainThread = std::this_thread::get_id() == mainThread && value == 5; });
+
+    // The continuation is queued once the task finished and runs with the frame jobs
+    auto start = std::chrono::steady_clock::now();
+    while (!published.isReady() && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+        frameJobs.run();
+        std::this_thread::yield();
+    }
+    if (!published.isReady() || !onMainThread) {
+        std::cerr << "continuation for the main thread did not run there" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testWhenChunkDone() {
+    ThreadManager pool(2);
+    WorldManager world(pool, 1, 1337);
+    Vec3 center(8, 136, 8);
+    world.updateChunks(center);
+
+    bool centerDone = false;
+    world.whenChunkDone(center).then([&centerDone](const bool& done) { centerDone = done; });
+    Future<bool> farAway = world.whenChunkDone(Vec3(4000, 136, 8));
+
+    auto start = std::chrono::steady_clock::now();
+    while (!centerDone && std::chrono::steady_clock::now() - start < std::chrono::seconds(30)) {
+        world.updateChunks(center);
+        std::this_thread::yield();
+    }
+    if (!centerDone || !farAway.isReady() || farAway.get()) {
+        std::cerr << "waiting for chunks did not report the loaded chunk done and the far one missing" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    bool passed = true;
+    passed &= testChain();
+    passed &= testMainThreadContinuation();
+    passed &= testWhenChunkDone();
+
+    std::cout << (passed ? "futureTest passed" : "futureTest FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include "world/WorldManager.h"
+
+// Generates a fixed region of a seeded world headlessly with 1..N worker threads.
+// Reports per stage timings, chunks per second and how busy the pool was, and checks the voxels against
+// a golden hash so generation stays deterministic for every thread count.
+//
+// usage: generationBenchmark [maxThreads]
+
+const unsigned int seed = 1337;
+const int updateDistance = 4;                  // 9 x 9 x 9 chunks
+const Vec3 regionCenter = Vec3(8, 136, 8);     // around the surface, with islands out of range
+
+// Update with the printed hash when generation changes on purpose
+const uint64_t goldenHash = 0x97688c7cb04137e7ULL;
+
+const double timeoutSeconds = 120.0;
+
+struct RunResult {
+    bool finished = false;
+    double seconds = 0.0;
+    uint64_t hash = 0;
+    int numChunks = 0;
+    double stageMs[STAGE_UPLOAD_READY + 1] = {};
+    ThreadPoolStats pool;
+};
+
+// FNV-1a over every voxel of the region, in the order of the flat chunk array
+uint64_t hashRegion(const WorldManager& world) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < world.numChunks; i++) {
+        const Chunk* chunk = world.chunks[i];
+        for (const Voxel& voxel : chunk->voxels) {
+            for (int byte = 0; byte < 4; byte++) {
+                hash ^= (voxel.data >> (byte * 8)) & 0xFF;
+                hash *= 1099511628211ULL;
+            }
+        }
+    }
+    return hash;
+}
+
+bool allDone(const WorldManager& world) {
+    for (int i = 0; i < world.numChunks; i++) {
+        if (!world.chunks[i] || world.chunks[i]->state != DONE) return false;
+    }
+    return true;
+}
+
+RunResult runRegion(int numThreads) {
+    RunResult result;
+    ThreadManager threadManager(numThreads);
+    WorldManager world(threadManager, updateDistance, seed);
+
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    while (elapsed < timeoutSeconds) {
+        world.updateChunks(regionCenter);
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (allDone(world)) {
+            result.finished = true;
+            break;
+        }
+        std::this_thread::yield();
+    }
+
+    result.seconds = elapsed;
+    result.numChunks = world.numChunks;
+    if (result.finished) {
+        result.hash = hashRegion(world);
+    }
+
+    const GenerationStats& stats = world.getGenerationStats();
+    for (int stage = 0; stage <= STAGE_UPLOAD_READY; stage++) {
+        result.stageMs[stage] = stats.averageMs((ChunkStage)stage);
+    }
+    result.pool = threadManager.getStats();
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    int maxThreads = argc > 1 ? std::max(1, atoi(argv[1])) : 2;
+
+    bool passed = true;
+    std::cout << std::fixed << std::setprecision(3);
+    for (int threads = 1; threads <= maxThreads; threads++) {
+        RunResult result = runRegion(threads);
+        if (!result.finished) {
+            std::cerr << threads << " threads: region did not finish within " << timeoutSeconds << "s" << std::endl;
+            passed = false;
+            continue;
+        }
+
+        std::cout << threads << " threads: " << result.numChunks << " chunks in " << result.seconds << "s, "
+                  << result.numChunks / result.seconds << " chunks/s" << std::endl;
+        std::cout << "  avg ms  column " << result.stageMs[STAGE_COLUMN]
+                  << "  terrain " << result.stageMs[STAGE_TERRAIN]
+                  << "  caves " << result.stageMs[STAGE_CAVES]
+                  << "  features " << result.stageMs[STAGE_FEATURES] << std::endl;
+
+        const ThreadPoolStats& pool = result.pool;
+        double busy = 0.0;
+        for (double workerBusy : pool.workerBusy) busy += workerBusy / pool.workerBusy.size();
+        std::cout << "  pool    busy " << busy * 100.0 << "%  peak queue " << pool.peakQueueDepth
+                  << "  wait ms column " << pool.categories[TASK_COLUMN].averageWaitMs
+                  << " (max " << pool.categories[TASK_COLUMN].maxWaitMs << ")"
+                  << "  terrain " << pool.categories[TASK_TERRAIN].averageWaitMs
+                  << " (max " << pool.categories[TASK_TERRAIN].maxWaitMs << ")"
+                  << "  features " << pool.categories[TASK_FEATURES].averageWaitMs
+                  << " (max " << pool.categories[TASK_FEATURES].maxWaitMs << ")" << std::endl;
+
+        if (result.hash != goldenHash) {
+            std::cerr << "  voxel hash 0x" << std::hex << result.hash << " does not match the golden hash 0x"
+                      << goldenHash << std::dec << std::endl;
+            passed = false;
+        }
+    }
+
+    std::cout << (passed ? "generationBenchmark passed" : "generationBenchmark FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "utilities/ScratchArena.h"
+#include "utilities/DensityField.h"
+#include "utilities/ThreadManager.h"
+
+// Checks bump allocation and rewinding of the scratch arena, and that work
+// using it stops allocating once the arena has grown
+
+std::atomic<long long> allocations(0);
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+bool testBumpAndAlignment() {
+    ScratchArena arena(1024);
+    char* a = (char*)arena.allocate(3, 1);
+    char* b = (char*)arena.allocate(8, 8);
+    char* c = (char*)arena.allocate(16, 64);
+    if (b < a + 3 || (uintptr_t)b % 8 != 0 || (uintptr_t)c % 64 != 0) {
+        std::cerr << "allocations overlap or are misaligned" << std::endl;
+        return false;
+    }
+
+    // A request larger than a block gets a block of its own
+    void* big = arena.allocate(4096, 16);
+    if (!big || arena.capacity() < 1024 + 4096) {
+        std::cerr << "large allocation did not grow the arena" << std::endl;
+        return false;
+    }
+
+    // After a reset the same memory is handed out again
+    arena.reset();
+    if (arena.allocate(3, 1) != a) {
+        std::cerr << "reset did not reuse the first block" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testNestedScopes() {
+    ScratchArena arena(256);
+    ScratchArena::Mark start = arena.mark();
+    void* inner = nullptr;
+    {
+        ScratchScope outer(arena);
+        std::pmr::vector<int> kept(10, 1, &arena);
+        {
+            ScratchScope nested(arena);
+            std::pmr::vector<int> temporary(200, 2, &arena);
+            inner = temporary.data();
+        }
+        // Memory of the nested scope is reused, the outer vector is untouched
+        std::pmr::vector<int> next(200, 3, &arena);
+        if (next.data() != inner || kept[9] != 1) {
+            std::cerr << "nested scope did not rewind to its own mark" << std::endl;
+            return false;
+        }
+    }
+    ScratchArena::Mark end = arena.mark();
+    if (end.block != start.block || end.offset != start.offset) {
+        std::cerr << "outer scope did not rewind the arena" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testNoAllocationsWhenWarm() {
+    DensityField field(4);
+    auto sampler = [](double x, double y, double z) { return x * 0.01 + y * 0.02 - z * 0.03; };
+    std::vector<float> out(32 * 32 * 32);
+
+    // The first fill grows the arena, later ones only reuse it
+    field.fill(Vec3(0, 0, 0), 32, 32, 32, sampler, out.data());
+    long long before = allocations;
+    for (int i = 0; i < 10; i++) {
+        field.fill(Vec3(i * 32.0f, 0, 0), 32, 32, 32, sampler, out.data());
+    }
+    long long during = allocations - before;
+    if (during != 0) {
+        std::cerr << "warm density fills allocated " << during << " times" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testWorkersRewind() {
+    // Tasks that leave scratch behind do not grow the workers' arenas
+    ThreadManager pool(2);
+    TaskGroup group(pool);
+    std::atomic<size_t> largest(0);
+    for (int i = 0; i < 200; i++) {
+        group.run([&largest]() {
+            ScratchArena& arena = ScratchArena::forThread();
+            std::pmr::vector<char> leftOver(64 * 1024, 0, &arena);
+            size_t capacity = arena.capacity();
+            size_t seen = largest;
+            while (capacity > seen && !largest.compare_exchange_weak(seen, capacity)) {}
+        });
+    }
+    group.wait();
+    if (largest > ScratchArena::defaultBlockSize) {
+        std::cerr << "worker arena grew to " << largest << " bytes" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    bool passed = true;
+    passed &= testBumpAndAlignment();
+    passed &= testNestedScopes();
+    passed &= testNoAllocationsWhenWarm();
+    passed &= testWorkersRewind();
+
+    std::cout << (passed ? "scratchArenaTest passed" : "scratchArenaTest FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
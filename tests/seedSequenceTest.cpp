@@ -0,0 +1,42 @@
+#include <iostream>
+#include <random>
+#include <vector>
+#include "utilities/SeedSequence.h"
+
+// Checks that the allocation free seed sequence generates the same values as std::seed_seq,
+// for every output length up to a Mersenne Twister's state and for seeds like chunk positions
+
+bool sameAsStd(const SeedSequence<5>& seq, size_t length) {
+    std::seed_seq expected(std::begin(seq.values), std::end(seq.values));
+    std::vector<uint32_t> a(length), b(length);
+    expected.generate(a.begin(), a.end());
+    seq.generate(b.begin(), b.end());
+    return a == b;
+}
+
+int main(int argc, char* argv[]) {
+    std::mt19937 rng(17);
+    bool passed = true;
+    for (int i = 0; i < 200 && passed; i++) {
+        // Seed, salt and chunk coordinates, some negative
+        SeedSequence<5> seq = { { (uint32_t)rng(), (uint32_t)(i % 7), (uint32_t)(int)(rng() % 4096) - 2048,
+                                  (uint32_t)(i * 32), (uint32_t)-(i * 32) } };
+        for (size_t length = 0; length <= 640 && passed; length++) {
+            if (!sameAsStd(seq, length)) {
+                std::cerr << "sequence differs from std::seed_seq for " << length << " values" << std::endl;
+                passed = false;
+            }
+        }
+
+        // The engine seeded by both starts the same
+        std::seed_seq expected(std::begin(seq.values), std::end(seq.values));
+        std::mt19937 fromStd(expected), fromOwn(seq);
+        if (fromStd() != fromOwn()) {
+            std::cerr << "engines seeded from the sequences differ" << std::endl;
+            passed = false;
+        }
+    }
+
+    std::cout << (passed ? "seedSequenceTest passed" : "seedSequenceTest FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
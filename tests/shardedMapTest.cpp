@@ -0,0 +1,88 @@
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "utilities/ShardedMap.h"
+#include "utilities/math/Vec3.h"
+
+// Checks the sharded map against concurrent writers and readers, the way
+// workers defer feature writes while the main thread looks up chunks
+
+const int numThreads = 4;
+
+bool testConcurrentUpdates() {
+    // Every thread adds to the same keys, no update may be lost
+    const int numKeys = 64;
+    const int rounds = 2000;
+    ShardedMap<Vec3, int, Vec3Hash> map;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&map]() {
+            for (int i = 0; i < rounds; i++) {
+                map.update(Vec3(i % numKeys, 0, -(i % 3)), [](int& count) { count++; });
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    long total = 0;
+    map.forEach([&total](const Vec3& key, const int& count) { total += count; });
+    if (total != numThreads * rounds) {
+        std::cerr << "concurrent updates counted " << total << " of " << numThreads * rounds << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testReadersWhileWriting() {
+    // One thread inserts and erases while others look up keys that always stay in the map
+    const int stableKeys = 32;
+    ShardedMap<Vec3, std::vector<int>, Vec3Hash> map;
+    for (int i = 0; i < stableKeys; i++) {
+        map.insert(Vec3(i, 1, 0), std::vector<int>(16, i));
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<int> misses(0);
+    std::vector<std::thread> readers;
+    for (int t = 0; t < numThreads - 1; t++) {
+        readers.emplace_back([&]() {
+            while (!stop) {
+                for (int i = 0; i < stableKeys; i++) {
+                    bool found = map.read(Vec3(i, 1, 0), [&](const std::vector<int>& value) {
+                        if (value.size() != 16 || value[15] != i) misses++;
+                    });
+                    if (!found) misses++;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 20000; i++) {
+        Vec3 key(i % 500, -1, 7);
+        map.insert(key, std::vector<int>(4, i));
+        std::vector<int> taken;
+        if (i % 2 == 0 && !map.take(key, taken)) misses++;
+    }
+    stop = true;
+    for (std::thread& reader : readers) reader.join();
+
+    if (misses != 0) {
+        std::cerr << misses << " lookups of stable keys failed while the map was written" << std::endl;
+        return false;
+    }
+    if (map.size() != (size_t)stableKeys + 250) {
+        std::cerr << "map holds " << map.size() << " entries, expected " << stableKeys + 250 << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    bool passed = true;
+    passed &= testConcurrentUpdates();
+    passed &= testReadersWhileWriting();
+
+    std::cout << (passed ? "shardedMapTest passed" : "shardedMapTest FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "utilities/ThreadManager.h"
+
+// Compares adding tasks from the main thread to the thread manager against a pool with one
+// locked queue that notifies a worker on every push, the way tasks used to be submitted.
+// Tasks are added in bursts like a frame crossing a chunk border, and every task must run.
+// The cost of adding is measured once with every worker busy, so only the submission path
+// is timed, and once end to end with the workers taking tasks while they are added.
+// The benchmark fails if the thread manager is slower than the locked queue in any of them,
+// with a small allowance for timer noise. With fewer cores than threads the workers run on
+// the main thread's core while it adds, so its wall time there measures the scheduler, and 
+// the check uses the CPU time of the main thread instead. Without optimizations the timings
+// say little about either pool, so they are only reported.
+//
+// usage: submissionBenchmark [numThreads]
+
+const int frames = 200;
+const int tasksPerFrame = 500;
+const int rounds = 5;
+const double tolerance = 1.05;
+
+// One shared queue behind a mutex and a condition variable
+class LockedPool {
+private:
+    std::deque<Task> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<std::thread> threads;
+    bool stop = false;
+
+public:
+    LockedPool(int numThreads) {
+        for (int i = 0; i < numThreads; i++) {
+            threads.emplace_back([this]() {
+                while (true) {
+                    Task task;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        condition.wait(lock, [this]() { return stop || !tasks.empty(); });
+                        if (stop && tasks.empty()) return;
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+
+    ~LockedPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        condition.notify_all();
+        for (std::thread& thread : threads) thread.join();
+    }
+
+    void addTask(Task task) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        condition.notify_one();
+    }
+};
+
+struct RunResult {
+    double busySubmitNs = 0.0;  // main thread time per added task while the workers are busy
+    double submitNs = 0.0;      // main thread time per added task while the workers take them
+    double submitCpuNs = 0.0;   // the same in CPU time of the main thread
+    double totalMs = 0.0;       // until every task ran
+    bool allRan = false;
+};
+
+double threadCpuNs() {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+// A little work per task so workers and the main thread overlap
+void work(std::atomic<int>& ran) {
+    volatile int sum = 0;
+    for (int i = 0; i < 200; i++) sum += i;
+    ran.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The lowest of each measurement, every round must have run all its tasks
+RunResult best(const RunResult& a, const RunResult& b, int round) {
+    if (round == 0) return b;
+    RunResult result;
+    result.busySubmitNs = std::min(a.busySubmitNs, b.busySubmitNs);
+    result.submitNs = std::min(a.submitNs, b.submitNs);
+    result.submitCpuNs = std::min(a.submitCpuNs, b.submitCpuNs);
+    result.totalMs = std::min(a.totalMs, b.totalMs);
+    result.allRan = a.allRan && b.allRan;
+    return result;
+}
+
+bool waitFor(std::atomic<int>& counter, int value) {
+    auto start = std::chrono::steady_clock::now();
+    while (counter.load() < value) {
+        if (std::chrono::steady_clock::now() - start > std::chrono::seconds(30)) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+template <typename Pool>
+RunResult run(Pool& pool, int numThreads) {
+    RunResult result;
+    std::atomic<int> ran(0);
+    const int total = frames * tasksPerFrame;
+
+    // Every worker blocks in a task while a burst is added, then they drain it
+    std::chrono::steady_clock::duration busySubmitting(0);
+    bool drained = true;
+    for (int frame = 0; frame < frames / 10 && drained; frame++) {
+        std::atomic<int> blocked(0);
+        std::atomic<int> released(0);
+        std::atomic<bool> release(false);
+        for (int i = 0; i < numThreads; i++) {
+            pool.addTask([&blocked, &released, &release]() {
+                blocked++;
+                while (!release) std::this_thread::sleep_for(std::chrono::microseconds(100));
+                released++;
+            });
+        }
+        drained = waitFor(blocked, numThreads);
+
+        std::atomic<int> burstRan(0);
+        auto burstStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < tasksPerFrame; i++) {
+            pool.addTask([&burstRan]() { work(burstRan); });
+        }
+        busySubmitting += std::chrono::steady_clock::now() - burstStart;
+
+        release = true;
+        drained = drained && waitFor(burstRan, tasksPerFrame) && waitFor(released, numThreads);
+    }
+    result.busySubmitNs = std::chrono::duration<double, std::nano>(busySubmitting).count() / (frames / 10 * tasksPerFrame);
+
+    auto start = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration submitting(0);
+    double submittingCpuNs = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        auto frameStart = std::chrono::steady_clock::now();
+        double frameCpuStart = threadCpuNs();
+        for (int i = 0; i < tasksPerFrame; i++) {
+            pool.addTask([&ran]() { work(ran); });
+        }
+        submitting += std::chrono::steady_clock::now() - frameStart;
+        submittingCpuNs += threadCpuNs() - frameCpuStart;
+    }
+    while (ran.load() < total && std::chrono::steady_clock::now() - start < std::chrono::seconds(30)) {
+        std::this_thread::yield();
+    }
+
+    result.submitNs = std::chrono::duration<double, std::nano>(submitting).count() / total;
+    result.submitCpuNs = submittingCpuNs / total;
+    result.totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    result.allRan = drained && ran.load() == total;
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    int numThreads = argc > 1 ? std::max(1, atoi(argv[1])) : 4;
+
+    // Alternating rounds, keeping the best of each, so a burst of noise hits both pools alike
+    RunResult locked, pooled;
+    for (int round = 0; round < rounds; round++) {
+        {
+            LockedPool pool(numThreads);
+            locked = best(locked, run(pool, numThreads), round);
+        }
+        {
+            ThreadManager pool(numThreads);
+            pooled = best(pooled, run(pool, numThreads), round);
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << numThreads << " threads, " << frames * tasksPerFrame << " tasks in bursts of " << tasksPerFrame << std::endl;
+    std::cout << "                  ns per add (busy)  ns per add  cpu ns per add  total ms" << std::endl;
+    std::cout << "  locked queue    " << std::setw(17) << locked.busySubmitNs << std::setw(12) << locked.submitNs
+              << std::setw(16) << locked.submitCpuNs << std::setw(10) << locked.totalMs << std::endl;
+    std::cout << "  thread manager  " << std::setw(17) << pooled.busySubmitNs << std::setw(12) << pooled.submitNs
+              << std::setw(16) << pooled.submitCpuNs << std::setw(10) << pooled.totalMs << std::endl;
+
+    bool passed = locked.allRan && pooled.allRan;
+    if (!passed) {
+        std::cerr << "not every task ran" << std::endl;
+    }
+    bool ownCores = std::thread::hardware_concurrency() > (unsigned int)numThreads;
+    bool slowerSubmit = ownCores ? pooled.submitNs > locked.submitNs * tolerance 
+                                 : pooled.submitCpuNs > locked.submitCpuNs * tolerance;
+    bool slower = pooled.busySubmitNs > locked.busySubmitNs * tolerance || slowerSubmit || pooled.totalMs > locked.totalMs * tolerance;
+#ifdef __OPTIMIZE__
+    if (slower) {
+        std::cerr << "thread manager is slower than the locked queue" << std::endl;
+        passed = false;
+    }
+#else
+    if (slower) {
+        std::cerr << "thread manager is slower than the locked queue, not checked in an unoptimized build" << std::endl;
+    }
+#endif
+    std::cout << (passed ? "submissionBenchmark passed" : "submissionBenchmark FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,294 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <set>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include "utilities/ThreadManager.h"
+
+// Checks that every task added to the pool runs exactly once, including tasks
+// added by other tasks, that shutting down drains the queues first, that
+// small tasks are queued and run without allocating, the parallelFor,
+// task group and batch helpers built on top, the pool's statistics and the
+// lock free queue tasks from outside the pool are submitted through
+
+// Counts every heap allocation in the test
+std::atomic<long> allocations(0);
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+bool testAllTasksRun() {
+    const int numTasks = 20000;
+    std::atomic<int> ran(0);
+    {
+        ThreadManager pool(4);
+        for (int i = 0; i < numTasks; i++) {
+            pool.addTask([&ran]() { ran++; });
+        }
+    }
+    if (ran != numTasks) {
+        std::cerr << "ran " << ran << " of " << numTasks << " tasks" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testSpawnedTasks() {
+    // Every task spawns two children down to a fixed depth
+    const int depth = 12;
+    const int expected = (1 << (depth + 1)) - 1;
+    std::atomic<int> ran(0);
+    {
+        ThreadManager pool(4);
+        std::function<void(int)> spawn = [&](int level) {
+            ran++;
+            if (level == depth) return;
+            pool.addTask([&spawn, level]() { spawn(level + 1); });
+            pool.addTask([&spawn, level]() { spawn(level + 1); });
+        };
+        pool.addTask([&spawn]() { spawn(0); });
+
+        // Spawned tasks are added while the pool runs, wait for them before shutting down
+        auto start = std::chrono::steady_clock::now();
+        while (ran < expected && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    if (ran != expected) {
+        std::cerr << "ran " << ran << " of " << expected << " spawned tasks" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testWorkIsShared() {
+    // One long task spawns the rest on its own worker, idle workers have to steal them
+    std::mutex idsMutex;
+    std::set<std::thread::id> ids;
+    std::atomic<int> ran(0);
+    const int numTasks = 64;
+    {
+        ThreadManager pool(4);
+        pool.addTask([&]() {
+            for (int i = 0; i < numTasks; i++) {
+                pool.addTask([&]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    std::lock_guard<std::mutex> lock(idsMutex);
+                    ids.insert(std::this_thread::get_id());
+                    ran++;
+                });
+            }
+        });
+        auto start = std::chrono::steady_clock::now();
+        while (ran < numTasks && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    if (ran != numTasks || ids.size() < 2) {
+        std::cerr << "spawned tasks ran on " << ids.size() << " threads, expected them to be stolen" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testMoveOnlyTasks() {
+    // Captures that cannot be copied, and one too large to be stored inline
+    std::atomic<int> sum(0);
+    {
+        ThreadManager pool(2);
+        auto value = std::make_unique<int>(5);
+        pool.addTask([&sum, value = std::move(value)]() { sum += *value; });
+
+        char large[256] = { 7 };
+        pool.addTask([&sum, large]() { sum += large[0]; });
+    }
+    if (sum != 12) {
+        std::cerr << "move only or large tasks did not run correctly" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testNoAllocations() {
+    const int numTasks = 1000;
+    std::atomic<int> ran(0);
+    ThreadManager pool(2);
+
+    struct Payload { void* a; void* b; void* c; int d; };
+    Payload payload = {};
+    long before = allocations.load();
+    for (int i = 0; i < numTasks; i++) {
+        pool.addTask([&ran, payload, i]() { ran += (payload.d + i) >= 0; });
+    }
+    while (ran < numTasks) {
+        std::this_thread::yield();
+    }
+    long allocated = allocations.load() - before;
+
+    if (allocated != 0) {
+        std::cerr << "queueing and running " << numTasks << " small tasks allocated " << allocated << " times" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testParallelFor() {
+    const int size = 10007;
+    std::vector<int> values(size, 0);
+    ThreadManager pool(4);
+    pool.parallelFor(0, size, 64, [&values](int begin, int end) {
+        for (int i = begin; i < end; i++) values[i] += i;
+    });
+    for (int i = 0; i < size; i++) {
+        if (values[i] != i) {
+            std::cerr << "parallelFor missed or repeated index " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testNestedWait() {
+    // A single worker waiting on its own group has to run the group's tasks itself
+    std::atomic<int> inner(0);
+    std::atomic<bool> done(false);
+    ThreadManager pool(1);
+    pool.addTask([&]() {
+        pool.parallelFor(0, 100, 1, [&inner](int begin, int end) { inner += end - begin; });
+        done = true;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    while (!done && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!done || inner != 100) {
+        std::cerr << "waiting inside a task did not finish its nested work" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testGroupAndBatch() {
+    std::atomic<int> ran(0);
+    ThreadManager pool(3);
+
+    TaskGroup group(pool);
+    for (int i = 0; i < 50; i++) {
+        group.run([&ran]() { ran++; });
+    }
+    group.wait();
+    if (ran != 50) {
+        std::cerr << "task group returned with " << 50 - ran << " tasks unfinished" << std::endl;
+        return false;
+    }
+
+    std::vector<Task> batch;
+    for (int i = 0; i < 50; i++) {
+        batch.push_back(Task([&ran]() { ran++; }));
+    }
+    pool.runBatch(batch);
+    if (ran != 100) {
+        std::cerr << "batch returned with " << 100 - ran << " tasks unfinished" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testStats() {
+    // Two workers and more sleeping tasks than workers, so some of them have to wait.
+    // Only every eighth task is timed, enough tasks that several of the timed ones wait
+    const int numTasks = 32;
+    ThreadManager pool(2);
+    pool.resetStats();
+
+    TaskGroup group(pool);
+    for (int i = 0; i < numTasks; i++) {
+        group.run([]() { std::this_thread::sleep_for(std::chrono::milliseconds(2)); }, TASK_TERRAIN);
+    }
+    group.wait();
+    ThreadPoolStats stats = pool.getStats();
+
+    const ThreadPoolStats::Category& terrain = stats.categories[TASK_TERRAIN];
+    bool passed = true;
+    if (terrain.tasks != numTasks || stats.categories[TASK_COLUMN].tasks != 0) {
+        std::cerr << "stats counted " << terrain.tasks << " of " << numTasks << " terrain tasks" << std::endl;
+        passed = false;
+    }
+    if (terrain.averageRunMs < 1.5 || terrain.maxWaitMs < 1.5 || terrain.maxWaitMs < terrain.averageWaitMs) {
+        std::cerr << "stats report " << terrain.averageRunMs << " ms run and " << terrain.maxWaitMs 
+                  << " ms max wait for tasks sleeping 2 ms" << std::endl;
+        passed = false;
+    }
+    if (stats.peakQueueDepth < 2 || stats.queueDepth != 0 || stats.workerBusy.size() != 2) {
+        std::cerr << "stats report a peak queue depth of " << stats.peakQueueDepth << std::endl;
+        passed = false;
+    }
+    return passed;
+}
+
+bool testSubmissionQueue() {
+    // Producers and consumers on a small queue, every value must come out exactly once
+    const int producers = 2, consumers = 2, perProducer = 50000;
+    MPMCQueue<int> queue(64);
+    std::vector<std::atomic<int>> seen(producers * perProducer);
+    std::atomic<int> popped(0);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p]() {
+            for (int i = 0; i < perProducer; i++) {
+                int value = p * perProducer + i;
+                while (!queue.tryPush(std::move(value))) std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&]() {
+            int value;
+            while (popped.load() < producers * perProducer) {
+                if (queue.tryPop(value)) {
+                    seen[value]++;
+                    popped++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    for (size_t i = 0; i < seen.size(); i++) {
+        if (seen[i] != 1) {
+            std::cerr << "submission queue delivered value " << i << " " << seen[i] << " times" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    bool passed = true;
+    passed &= testAllTasksRun();
+    passed &= testSpawnedTasks();
+    passed &= testWorkIsShared();
+    passed &= testMoveOnlyTasks();
+    passed &= testNoAllocations();
+    passed &= testParallelFor();
+    passed &= testNestedWait();
+    passed &= testGroupAndBatch();
+    passed &= testStats();
+    passed &= testSubmissionQueue();
+
+    std::cout << (passed ? "threadManagerTest passed" : "threadManagerTest FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,258 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <unordered_set>
+#include "world/WorldManager.h"
+#include "world/VoxelCursor.h"
+#include "physics/PhysicsEngine.h"
+
+// Checks that the flat chunk array and the neighbour links follow the center as it 
+// moves by single chunks and jumps far away, that the world settles with every chunk done,
+// that other threads can look up chunks while it moves, that a voxel cursor reads the same
+// voxels as the world manager, that clouds do not block,
+// and that generation keeps the workers busy between updates at a game's frame rate
+
+const int updateDistance = 2;
+
+bool allDone(const WorldManager& world) {
+    for (int i = 0; i < world.numChunks; i++) {
+        if (!world.chunks[i] || world.chunks[i]->state != DONE) return false;
+    }
+    return true;
+}
+
+// Every slot holds the chunk at its position relative to the center, each with its own buffer offset
+bool chunksMatchCenter(const WorldManager& world, const Vec3& center) {
+    Vec3 centerChunkPos = floor(center / CHUNKSIZE);
+    std::unordered_set<int> offsets;
+    int idx = 0;
+    for (int z = -updateDistance; z <= updateDistance; z++) {
+        for (int y = -updateDistance; y <= updateDistance; y++) {
+            for (int x = -updateDistance; x <= updateDistance; x++, idx++) {
+                Chunk* chunk = world.chunks[idx];
+                Vec3 expected = (centerChunkPos + Vec3(x, y, z)) * CHUNKSIZE;
+                if (!chunk || chunk->worldPosition != expected || !offsets.insert(chunk->bufferOffset).second) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Every chunk links to the chunks next to it in the array, and to nothing outside the box
+bool neighboursMatch(const WorldManager& world) {
+    const int edge = updateDistance * 2 + 1;
+    for (int z = 0; z < edge; z++) {
+        for (int y = 0; y < edge; y++) {
+            for (int x = 0; x < edge; x++) {
+                Chunk* chunk = world.chunks[x + y * edge + z * edge * edge];
+                for (int dz = -1; dz <= 1; dz++) {
+                    for (int dy = -1; dy <= 1; dy++) {
+                        for (int dx = -1; dx <= 1; dx++) {
+                            int nx = x + dx, ny = y + dy, nz = z + dz;
+                            bool inBox = nx >= 0 && nx < edge && ny >= 0 && ny < edge && nz >= 0 && nz < edge;
+                            Chunk* expected = inBox ? world.chunks[nx + ny * edge + nz * edge * edge] : nullptr;
+                            if (chunk->getNeighbour(dx, dy, dz) != expected) return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool testMovingCenter() {
+    ThreadManager pool(2);
+    WorldManager world(pool, updateDistance, 1337);
+    std::mt19937 rng(7);
+    Vec3 center(8, 136, 8);
+
+    for (int frame = 0; frame < 300; frame++) {
+        if (frame % 50 == 49) {
+            center = Vec3((int)(rng() % 4000) - 2000, 60 + rng() % 200, (int)(rng() % 4000) - 2000);
+        } else if (frame % 3 == 0) {
+            center += Vec3((int)(rng() % 3) - 1, (int)(rng() % 3) - 1, (int)(rng() % 3) - 1) * CHUNKSIZE;
+        }
+        world.updateChunks(center);
+        if (!chunksMatchCenter(world, center)) {
+            std::cerr << "chunk array does not match the center at frame " << frame << std::endl;
+            return false;
+        }
+        if (!neighboursMatch(world)) {
+            std::cerr << "neighbour links do not match the chunk array at frame " << frame << std::endl;
+            return false;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (!allDone(world) && std::chrono::steady_clock::now() - start < std::chrono::seconds(30)) {
+        world.updateChunks(center);
+        std::this_thread::yield();
+    }
+    if (!allDone(world)) {
+        std::cerr << "world did not settle after the center stopped moving" << std::endl;
+        return false;
+    }
+
+    // Staying in the same chunk keeps every chunk where it is
+    Chunk* first = world.chunks[0];
+    world.updateChunks(floor(center / CHUNKSIZE) * CHUNKSIZE + Vec3(CHUNKSIZE - 1));
+    if (world.chunks[0] != first) {
+        std::cerr << "chunks moved without the center changing chunk" << std::endl;
+        return false;
+    }
+
+    // Positions just outside a chunk read the same voxels as the world
+    Chunk* middle = world.chunks[world.numChunks / 2];
+    const Vec3 nearby[4] = { Vec3(-1, 0, 0), Vec3(16, 15, -1), Vec3(-1, -1, -1), Vec3(31, 31, 31) };
+    for (const Vec3& localPos : nearby) {
+        if (middle->getVoxelNear(localPos) != world.getVoxel(middle->worldPosition + localPos)) {
+            std::cerr << "voxel next to a chunk was not read from its neighbour" << std::endl;
+            return false;
+        }
+    }
+    if (middle->getVoxelNear(Vec3(32, 0, 0)) != nullptr) {
+        std::cerr << "voxel two chunks away was resolved" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testLookupFromOtherThread() {
+    ThreadManager pool(2);
+    WorldManager world(pool, updateDistance, 1337);
+    std::atomic<bool> moving(true);
+    std::atomic<int> found(0), wrong(0);
+
+    // Looks up positions around the path of the center while the main thread loads and unloads
+    std::thread reader([&]() {
+        std::mt19937 rng(5);
+        while (moving) {
+            Vec3 position((int)(rng() % 640) - 64, 60 + rng() % 160, (int)(rng() % 96) - 48);
+            std::shared_ptr<Chunk> chunk = world.findChunk(position);
+            if (!chunk) continue;
+            found++;
+            if (chunk->worldPosition != floor(position / CHUNKSIZE) * CHUNKSIZE) wrong++;
+        }
+    });
+    Vec3 center(8, 136, 8);
+    for (int frame = 0; frame < 200; frame++) {
+        center.x = 8 + (frame % 100) * 5;
+        world.updateChunks(center);
+        std::this_thread::yield();
+    }
+    moving = false;
+    reader.join();
+
+    if (found == 0 || wrong > 0) {
+        std::cerr << "lookups from another thread found " << found << " chunks, " << wrong << " wrong" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testVoxelCursor() {
+    ThreadManager pool(2);
+    WorldManager world(pool, updateDistance, 1337);
+    Vec3 center(8, 136, 8);
+    world.updateChunks(center);
+
+    // Single steps, steps across several voxels and jumps out of the loaded box
+    std::mt19937 rng(11);
+    VoxelCursor cursor(world, center);
+    Vec3 position = floor(center);
+    for (int i = 0; i < 20000; i++) {
+        if (i % 1000 == 999) {
+            position = floor(center) + Vec3((int)(rng() % 200) - 100, (int)(rng() % 200) - 100, (int)(rng() % 200) - 100);
+            cursor.moveTo(position + Vec3(0.5f));
+        } else if (i % 10 == 0) {
+            Vec3 step((int)(rng() % 9) - 4, (int)(rng() % 9) - 4, (int)(rng() % 9) - 4);
+            position += step;
+            cursor.moveTo(position);
+        } else {
+            int axis = rng() % 3, direction = rng() % 2 ? 1 : -1;
+            position += Vec3(axis == 0 ? direction : 0, axis == 1 ? direction : 0, axis == 2 ? direction : 0);
+            cursor.move(axis == 0 ? direction : 0, axis == 1 ? direction : 0, axis == 2 ? direction : 0);
+        }
+        if (cursor.getPosition() != position || cursor.get() != world.getVoxel(position)) {
+            std::cerr << "cursor disagrees with the world at step " << i << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testCloudsPassThrough() {
+    ThreadManager pool(2);
+    WorldManager world(pool, updateDistance, 1337);
+    Vec3 center(8, 136, 8);
+    auto start = std::chrono::steady_clock::now();
+    do {
+        world.updateChunks(center);
+        std::this_thread::yield();
+    } while (!allDone(world) && std::chrono::steady_clock::now() - start < std::chrono::seconds(30));
+
+    // A row of air with a cloud in the middle and stone at the end
+    Vec3 origin = floor(center);
+    for (int x = 0; x < 8; x++) {
+        *world.getVoxel(origin + Vec3(x, 0, 0)) = ID_AIR;
+        *world.getVoxel(origin + Vec3(x, 1, 0)) = ID_AIR;
+    }
+    *world.getVoxel(origin + Vec3(3, 0, 0)) = ID_CLOUD;
+    *world.getVoxel(origin + Vec3(6, 0, 0)) = ID_STONE;
+
+    Vec3 voxelPos, normal;
+    bool hit = world.worldRayDetection(origin + Vec3(0.5f), origin + Vec3(7.5f, 0.5f, 0.5f), voxelPos, normal);
+    if (world.positionIsSolid(origin + Vec3(3, 0, 0)) || !hit || voxelPos != origin + Vec3(6, 0, 0)) {
+        std::cerr << "ray stopped at a cloud instead of the stone behind it" << std::endl;
+        return false;
+    }
+
+    // A shape moving into the cloud keeps moving
+    PhysicsEngine physics(world);
+    Shape shape(origin + Vec3(2.5f, 0.9f, 0.5f), Vec3(0.8f));
+    shape.velocity = Vec3(1, 0, 0);
+    physics.addShape(&shape);
+    physics.update(0.5f);
+    if (shape.position.x < origin.x + 2.9f) {
+        std::cerr << "shape collided with a cloud" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool testFramePacedGeneration() {
+    // Updates 16 ms apart like frames. Handing out chunks only in the update would need
+    // at least 729 / (2 workers * 4) = 92 updates, workers that refill take a few
+    const int distance = 4;
+    const int maxFrames = 40;
+    ThreadManager pool(2);
+    WorldManager world(pool, distance, 1337);
+    Vec3 center(8, 136, 8);
+    int frames = 0;
+    while (frames < 200) {
+        world.updateChunks(center);
+        frames++;
+        if (allDone(world)) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+    if (frames > maxFrames) {
+        std::cerr << "world took " << frames << " frames to generate, workers waited for updates" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    bool passed = true;
+    passed &= testMovingCenter();
+    passed &= testLookupFromOtherThread();
+    passed &= testVoxelCursor();
+    passed &= testCloudsPassThrough();
+    passed &= testFramePacedGeneration();
+
+    std::cout << (passed ? "worldManagerTest passed" : "worldManagerTest FAILED") << std::endl;
+    return passed ? 0 : 1;
+}